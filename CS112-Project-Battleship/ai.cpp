@@ -0,0 +1,867 @@
+#include "ai.h"
+
+#include <array>
+
+// Picks a uniformly random cell that holds neither a hit nor a miss on the tracking board
+Position randomUntargetedCell(const Board &tracking, Rng &rng)
+{
+    Bitboard open = ~(tracking.getHitCells() | tracking.getMissCells());
+    int count = popCount(open);
+    if (count == 0)
+    {
+        return Position(-1, -1);
+    }
+
+    // skip the k lowest open cells, then take the next one
+    int k = static_cast<int>(rng.below(count));
+    for (int i = 0; i < k; i++)
+    {
+        open &= open - 1;
+    }
+    int index = lowestCell(open);
+    return Position(index % BOARD_SIZE, index / BOARD_SIZE);
+}
+
+// Returns valid adjacent positions for smart CPU targeting
+std::vector<Position> getAdjacentPositions(int x, int y)
+{
+    std::vector<Position> adj;
+    if (x > 0)
+        adj.push_back(Position(x - 1, y));
+    if (x < BOARD_SIZE - 1)
+        adj.push_back(Position(x + 1, y));
+    if (y > 0)
+        adj.push_back(Position(x, y - 1));
+    if (y < BOARD_SIZE - 1)
+        adj.push_back(Position(x, y + 1));
+    return adj;
+}
+
+// RandomTargeting keeps no state between shots, so it uses the default reset and recordResult
+Position RandomTargeting::chooseTarget(const Board &tracking, Rng &rng)
+{
+    return randomUntargetedCell(tracking, rng);
+}
+
+// HuntTargeting implementation
+HuntTargeting::HuntTargeting() : hunting(false) {}
+
+// Forgets any pending hunt targets from a previous game
+void HuntTargeting::reset()
+{
+    huntTargets.clear();
+    hunting = false;
+}
+
+// Takes the most recently queued hunt target, or a random cell when there is nothing to hunt
+Position HuntTargeting::chooseTarget(const Board &tracking, Rng &rng)
+{
+    while (hunting && !huntTargets.empty())
+    {
+        Position p = huntTargets.back();
+        huntTargets.pop_back();
+        // Skip targets that were fired upon since they were queued
+        if (tracking.isEmptyCell(p.x, p.y))
+        {
+            return p;
+        }
+    }
+
+    // Not hunting or no hunt targets left, switch to random targeting
+    hunting = false;
+    return randomUntargetedCell(tracking, rng);
+}
+
+// After a hit, queues the untargeted neighbours of the hit cell
+void HuntTargeting::recordResult(const Board &tracking, const Position &target, const ShotResult &result)
+{
+    if (result.outcome != SHOT_HIT && result.outcome != SHOT_SUNK)
+    {
+        return;
+    }
+
+    hunting = true;
+    for (const auto &pt : getAdjacentPositions(target.x, target.y))
+    {
+        // Add only untargeted cells that are not already queued
+        if (!tracking.isEmptyCell(pt.x, pt.y))
+            continue;
+
+        bool alreadyInTargets = false;
+        for (const auto &ht : huntTargets)
+        {
+            if (ht == pt)
+            {
+                alreadyInTargets = true;
+                break;
+            }
+        }
+        if (!alreadyInTargets)
+            huntTargets.push_back(pt);
+    }
+}
+
+// ProbabilityMap implementation
+namespace
+{
+    const int CELLS = BOARD_SIZE * BOARD_SIZE;
+    // Pending shots from which DensityTargeting recounts its map in one bulk pass instead of
+    // replaying them one by one (after a cache hit streak, typically)
+    const std::size_t RECOUNT_BACKLOG = 8;
+
+    // Number of (placement, cell) pairs in the placement table
+    constexpr int coveredCellTotal()
+    {
+        int total = 0;
+        for (int i = 0; i < PLACEMENT_TOTAL; i++)
+            total += PLACEMENTS[i].length;
+        return total;
+    }
+
+    // For every cell, the table indices of the placements covering it, stored back to back:
+    // the placements over cell c are entries[offsets[c]] to entries[offsets[c + 1] - 1]
+    struct CellPlacements
+    {
+        std::array<std::uint16_t, CELLS + 1> offsets;
+        std::array<std::uint16_t, coveredCellTotal()> entries;
+    };
+
+    constexpr CellPlacements buildCellPlacements()
+    {
+        CellPlacements index{};
+        for (int i = 0; i < PLACEMENT_TOTAL; i++)
+        {
+            for (int cell = 0; cell < CELLS; cell++)
+            {
+                if (PLACEMENTS[i].mask & cellBit(cell))
+                    index.offsets[cell + 1]++;
+            }
+        }
+        for (int cell = 0; cell < CELLS; cell++)
+            index.offsets[cell + 1] += index.offsets[cell];
+
+        std::array<int, CELLS> next{};
+        for (int i = 0; i < PLACEMENT_TOTAL; i++)
+        {
+            for (int cell = 0; cell < CELLS; cell++)
+            {
+                if (PLACEMENTS[i].mask & cellBit(cell))
+                    index.entries[index.offsets[cell] + next[cell]++] = static_cast<std::uint16_t>(i);
+            }
+        }
+        return index;
+    }
+
+    constexpr CellPlacements CELL_PLACEMENTS = buildCellPlacements();
+
+    // Calls visit(index) for every placement covering cell
+    template <class Visit>
+    void forEachPlacementOver(int cell, Visit visit)
+    {
+        for (int i = CELL_PLACEMENTS.offsets[cell]; i < CELL_PLACEMENTS.offsets[cell + 1]; i++)
+            visit(CELL_PLACEMENTS.entries[i]);
+    }
+}
+
+ProbabilityMap::ProbabilityMap()
+{
+    reset(CLASSIC_PLAYER_FLEET);
+}
+
+// Starts from an empty tracking board: every placement survives
+void ProbabilityMap::reset(const Fleet &fleet)
+{
+    int ships[MAX_SHIP_LENGTH + 1] = {0};
+    for (int i = 0; i < fleet.size; i++)
+        ships[fleet.ships[i].length]++;
+    recount(ships, 0, 0);
+}
+
+// Rebuilds the counts with the bulk placement-counting kernel
+void ProbabilityMap::recount(const int ships[MAX_SHIP_LENGTH + 1], Bitboard blockedCells, Bitboard unresolvedHits)
+{
+    for (int cell = 0; cell < CELLS; cell++)
+    {
+        density[cell] = 0;
+        hitDensity[cell] = 0;
+    }
+    for (int length = 0; length <= MAX_SHIP_LENGTH; length++)
+        shipsLeft[length] = ships[length];
+    countPlacements(PLACEMENTS.data(), PLACEMENT_TOTAL, blockedCells, unresolvedHits, shipsLeft, coverage, density, hitDensity);
+    blocked = blockedCells;
+    unresolved = unresolvedHits;
+    shot = blockedCells | unresolvedHits;
+}
+
+// Takes a surviving placement out of both counts
+void ProbabilityMap::removePlacement(int index)
+{
+    const Placement &placement = PLACEMENTS[index];
+    int ships = shipsLeft[placement.length];
+    int hitWeight = ships * coverage[index];
+    coverage[index] = REMOVED;
+    if (ships == 0)
+        return;
+    for (Bitboard cells = placement.mask; cells; clearLowestCell(cells))
+    {
+        int cell = lowestCell(cells);
+        density[cell] -= ships;
+        hitDensity[cell] -= hitWeight;
+    }
+}
+
+// No ship can lie across cell any more: removes the placements through it
+void ProbabilityMap::block(int cell)
+{
+    blocked |= cellBit(cell);
+    forEachPlacementOver(cell, [&](int index)
+                         {
+        if (coverage[index] != REMOVED)
+            removePlacement(index); });
+}
+
+void ProbabilityMap::miss(int cell)
+{
+    shot |= cellBit(cell);
+    block(cell);
+}
+
+// Every surviving placement through the hit now covers one more unresolved hit
+void ProbabilityMap::hit(int cell)
+{
+    shot |= cellBit(cell);
+    unresolved |= cellBit(cell);
+    forEachPlacementOver(cell, [&](int index)
+                         {
+        if (coverage[index] == REMOVED)
+            return;
+        coverage[index]++;
+        int ships = shipsLeft[PLACEMENTS[index].length];
+        for (Bitboard cells = PLACEMENTS[index].mask; ships && cells; clearLowestCell(cells))
+            hitDensity[lowestCell(cells)] += ships; });
+}
+
+// The cells shared by every placement of the ship through cell that lies on unresolved hits
+Bitboard ProbabilityMap::sunkCells(int cell, int length, Bitboard unresolved)
+{
+    Bitboard common = ~Bitboard(0);
+    forEachPlacementOver(cell, [&](int index)
+                         {
+        Bitboard mask = PLACEMENTS[index].mask;
+        if (PLACEMENTS[index].length == length && (mask & unresolved) == mask)
+            common &= mask; });
+    return (common == ~Bitboard(0)) ? cellBit(cell) : common;
+}
+
+// Blocks the cells attributed to the sunk ship, then drops one ship of that length from the counts
+void ProbabilityMap::sink(int cell, int length)
+{
+    Bitboard sunk = sunkCells(cell, length, unresolved);
+
+    unresolved &= ~sunk;
+    for (Bitboard cells = sunk & ~blocked; cells; clearLowestCell(cells))
+        block(lowestCell(cells));
+
+    if (length < 1 || length > MAX_SHIP_LENGTH || shipsLeft[length] == 0)
+        return;
+    shipsLeft[length]--;
+    for (int i = placementsBegin(length); i < placementsEnd(length); i++)
+    {
+        if (coverage[i] == REMOVED)
+            continue;
+        for (Bitboard cells = PLACEMENTS[i].mask; cells; clearLowestCell(cells))
+        {
+            int c = lowestCell(cells);
+            density[c]--;
+            hitDensity[c] -= coverage[i];
+        }
+    }
+}
+
+// DensityTargeting implementation
+// Target choice by weight shared by the density, exact and sampling strategies, and the sink
+// bookkeeping of the last two
+namespace
+{
+    // Scans the open cells in index order for the highest positive weight
+    template <class Weight>
+    CachedDecision scanWeights(Bitboard open, const Weight *weights)
+    {
+        CachedDecision decision = {0, 0};
+        Weight best = 0;
+        for (; open; clearLowestCell(open))
+        {
+            int index = lowestCell(open);
+            if (weights[index] > best)
+            {
+                best = weights[index];
+                decision.raises |= cellBit(index);
+            }
+            else if (weights[index] == best && best > 0)
+            {
+                decision.draws |= cellBit(index);
+            }
+        }
+        return decision;
+    }
+
+    // Replays a scan: a raise takes the lead, a tie takes it with probability 1 / (number of ties).
+    // Returns the cell chosen, or -1 if no cell had any weight.
+    int replayDecision(const CachedDecision &decision, Rng &rng)
+    {
+        int ties = 0;
+        int bestIndex = -1;
+        for (Bitboard cells = decision.raises | decision.draws; cells; clearLowestCell(cells))
+        {
+            int index = lowestCell(cells);
+            if (decision.raises & cellBit(index))
+            {
+                bestIndex = index;
+                ties = 1;
+            }
+            else if (rng.below(++ties) == 0)
+            {
+                bestIndex = index;
+            }
+        }
+        return bestIndex;
+    }
+
+    // Records in query which ship a sink reported and the hits it could have covered; returns the
+    // ship's index, or -1 if the result is not the sink of a ship of the fleet
+    int noteSink(ArrangementQuery &query, const Board &tracking, const Position &target, const ShotResult &result)
+    {
+        int ship = shipIndexOf(result.shipType);
+        if (result.outcome != SHOT_SUNK || ship < 0 || ship >= query.shipCount)
+            return -1;
+        int cell = cellIndex(target.x, target.y);
+        ShipKnowledge &known = query.ships[ship];
+        known.sunk = true;
+        known.sunkCell = cell;
+        known.hitsAtSink = tracking.getHitCells() | cellBit(cell);
+        return ship;
+    }
+
+    // Accepted draws below which SamplingTargeting counts exactly instead
+    const unsigned long long MIN_ACCEPTED_DRAWS = 1000;
+
+    SamplingLimits currentSamplingLimits = {200000, 100, 0};
+
+    // Draws in the first sampling round of an anytime decision; each later round draws twice as many
+    const unsigned int FIRST_ROUND_DRAWS = 16384;
+    // Accepted draws after which an anytime decision stops refining before its deadline
+    const unsigned long long ENOUGH_ACCEPTED_DRAWS = 50000;
+
+    // Cells orthogonally next to a cell of cells
+    Bitboard neighbourCells(Bitboard cells)
+    {
+        const Bitboard FIRST_COLUMN = 0x0101010101010101ULL;
+        const Bitboard LAST_COLUMN = FIRST_COLUMN << (BOARD_SIZE - 1);
+        return ((cells & ~LAST_COLUMN) << 1) | ((cells & ~FIRST_COLUMN) >> 1) | (cells << BOARD_SIZE) | (cells >> BOARD_SIZE);
+    }
+
+    // Milliseconds left until deadline, 0 once it has passed
+    double millisecondsUntil(Deadline deadline)
+    {
+        std::chrono::duration<double, std::milli> left = deadline - std::chrono::steady_clock::now();
+        return left.count() > 0 ? left.count() : 0;
+    }
+
+    // Ships of each length still afloat in query
+    void shipsAfloat(const ArrangementQuery &query, int ships[MAX_SHIP_LENGTH + 1])
+    {
+        for (int length = 0; length <= MAX_SHIP_LENGTH; length++)
+            ships[length] = 0;
+        for (int i = 0; i < query.shipCount; i++)
+            if (!query.ships[i].sunk)
+                ships[query.ships[i].length]++;
+    }
+
+    // Parity: finish wounded ships first, otherwise sweep the checkerboard of the shortest ship afloat
+    CachedDecision parityDecision(const ArrangementQuery &query, Bitboard sunk)
+    {
+        Bitboard open = ~(query.hits | query.misses);
+        int spacing = MAX_SHIP_LENGTH;
+        for (int i = 0; i < query.shipCount; i++)
+            if (!query.ships[i].sunk)
+                spacing = std::min(spacing, query.ships[i].length);
+        int parity[BOARD_SIZE * BOARD_SIZE] = {0};
+        for (Bitboard cells = open; cells; clearLowestCell(cells))
+        {
+            int index = lowestCell(cells);
+            parity[index] = (index % BOARD_SIZE + index / BOARD_SIZE) % spacing == 0 ? 1 : 0;
+        }
+        for (Bitboard cells = open & neighbourCells(query.hits & ~sunk); cells; clearLowestCell(cells))
+            parity[lowestCell(cells)] = 2;
+        return scanWeights(open, parity);
+    }
+
+    // Density: every remaining ship counted on its own against the misses and sunk ships, in map.
+    // The decision has no raises if no ship fits anywhere.
+    CachedDecision densityDecision(const ArrangementQuery &query, Bitboard sunk, ProbabilityMap &map)
+    {
+        int ships[MAX_SHIP_LENGTH + 1];
+        shipsAfloat(query, ships);
+        map.recount(ships, query.misses | sunk, query.hits & ~sunk);
+        return scanWeights(~(query.hits | query.misses), map.getWeights());
+    }
+
+    // Draws an anytime decision may make, in units of samplingLimits().draws, however far its
+    // deadline is
+    const unsigned long long ANYTIME_DRAW_BUDGETS = 16;
+}
+
+DensityTargeting::DensityTargeting(TranspositionCache *decisions)
+    : queued(0), queuedHits(0), sunk(0), sunkHash(0), sunkCounts(0), decisions(decisions)
+{
+}
+
+// Starts a new game against a full fleet; copying a prepared map is cheaper than recounting it
+void DensityTargeting::reset()
+{
+    static const ProbabilityMap FULL_FLEET;
+    map = FULL_FLEET;
+    pending.clear();
+    queued = 0;
+    queuedHits = 0;
+    sunk = 0;
+    sunkHash = 0;
+    sunkCounts = 0;
+}
+
+// Queues a shot for the map and, for a sink, adds the ship's cells to the position's key
+void DensityTargeting::queue(int cell, ShotOutcome outcome, int length)
+{
+    queued |= cellBit(cell);
+    if (outcome != SHOT_MISS)
+        queuedHits |= cellBit(cell);
+    if (pending.full())
+        catchUp();
+    pending.push_back(PendingShot{static_cast<std::uint8_t>(cell), static_cast<std::uint8_t>(outcome), static_cast<std::uint8_t>(length)});
+    if (outcome != SHOT_SUNK)
+        return;
+
+    // The same attribution ProbabilityMap::sink will make: every hit so far that is not yet sunk is unresolved
+    Bitboard cells = ProbabilityMap::sunkCells(cell, length, queuedHits & ~sunk);
+    for (Bitboard added = cells & ~sunk; added; clearLowestCell(added))
+        sunkHash ^= zobristKey(lowestCell(added), ZOBRIST_SUNK);
+    sunk |= cells;
+    if (length >= 1 && length <= MAX_SHIP_LENGTH && (sunkCounts >> (4 * length) & 0xf) < 0xf)
+        sunkCounts += std::uint64_t(1) << (4 * length);
+}
+
+// Queues shots on tracking that the strategy was not told about (other than skip) as plain hits and misses
+void DensityTargeting::queueUnseen(const Board &tracking, Bitboard skip)
+{
+    Bitboard hits = tracking.getHitCells() & ~queued & ~skip;
+    Bitboard misses = tracking.getMissCells() & ~queued & ~skip;
+    for (; hits; clearLowestCell(hits))
+        queue(lowestCell(hits), SHOT_HIT, 0);
+    for (; misses; clearLowestCell(misses))
+        queue(lowestCell(misses), SHOT_MISS, 0);
+}
+
+// Applies the pending shots to the map in the order they were fired, or recounts the map from
+// the position when that is cheaper than replaying a long backlog
+void DensityTargeting::catchUp()
+{
+    if (pending.size() >= RECOUNT_BACKLOG)
+    {
+        int ships[MAX_SHIP_LENGTH + 1] = {0};
+        for (int i = 0; i < CLASSIC_PLAYER_FLEET.size; i++)
+            ships[CLASSIC_PLAYER_FLEET.ships[i].length]++;
+        for (int length = 1; length <= MAX_SHIP_LENGTH; length++)
+        {
+            int sunkShips = static_cast<int>(sunkCounts >> (4 * length) & 0xf);
+            ships[length] = ships[length] > sunkShips ? ships[length] - sunkShips : 0;
+        }
+        map.recount(ships, (queued & ~queuedHits) | sunk, queuedHits & ~sunk);
+        pending.clear();
+        return;
+    }
+
+    for (const auto &shot : pending)
+    {
+        if (shot.outcome == SHOT_MISS)
+        {
+            map.miss(shot.cell);
+            continue;
+        }
+        map.hit(shot.cell);
+        if (shot.outcome == SHOT_SUNK)
+            map.sink(shot.cell, shot.length);
+    }
+    pending.clear();
+}
+
+// Fires at the untargeted cell covered by the most consistent placements; ties are broken at random.
+// The scan's outcome is looked up in the cache first, if there is one, and stored there after a recount.
+Position DensityTargeting::chooseTarget(const Board &tracking, Rng &rng)
+{
+    queueUnseen(tracking, 0);
+    std::uint64_t key = deriveSeed(tracking.getStateHash() ^ sunkHash, sunkCounts);
+    CachedDecision decision;
+    if (!decisions || !decisions->find(key, decision))
+    {
+        catchUp();
+        decision = scanWeights(~map.getShotCells(), map.getWeights());
+        if (decisions)
+            decisions->store(key, decision);
+    }
+
+    int bestIndex = replayDecision(decision, rng);
+    if (bestIndex < 0)
+    {
+        // No consistent placement left (e.g. a sink was misattributed): fall back to random fire
+        return randomUntargetedCell(tracking, rng);
+    }
+    return Position(bestIndex % BOARD_SIZE, bestIndex / BOARD_SIZE);
+}
+
+// Queues the result of the strategy's own shot for the map
+void DensityTargeting::recordResult(const Board &tracking, const Position &target, const ShotResult &result)
+{
+    if (result.outcome != SHOT_MISS && result.outcome != SHOT_HIT && result.outcome != SHOT_SUNK)
+    {
+        return; // the shot changed nothing
+    }
+    int cell = cellIndex(target.x, target.y);
+    queueUnseen(tracking, cellBit(cell));
+    if (queued & cellBit(cell))
+    {
+        return;
+    }
+    queue(cell, result.outcome, result.outcome == SHOT_SUNK ? shipLengthOf(result.shipType) : 0);
+}
+
+ExactTargeting::ExactTargeting() : query(freshArrangementQuery(CLASSIC_PLAYER_FLEET)), sinkHash(0), sunk(0) {}
+
+// Forgets the previous game
+void ExactTargeting::reset()
+{
+    query = freshArrangementQuery(CLASSIC_PLAYER_FLEET);
+    sinkHash = 0;
+    sunk = 0;
+}
+
+Position ExactTargeting::chooseTarget(const Board &tracking, Rng &rng)
+{
+    return chooseTargetBefore(tracking, rng, Deadline::max());
+}
+
+// Fires at the untargeted cell that holds a ship in the most consistent arrangements; ties are
+// broken at random exactly as density targeting breaks them. A count still running at deadline
+// is abandoned for the density answer (the parity answer if no ship fits on its own), which is
+// not cached.
+Position ExactTargeting::chooseTargetBefore(const Board &tracking, Rng &rng, Deadline deadline)
+{
+    std::uint64_t key = deriveSeed(tracking.getStateHash(), sinkHash);
+    TranspositionCache &cache = TranspositionCache::exactDecisions();
+    CachedDecision decision;
+    if (!cache.find(key, decision))
+    {
+        query.hits = tracking.getHitCells();
+        query.misses = tracking.getMissCells();
+        ArrangementCounts counts;
+        if (countArrangements(query, samplingLimits().threads, deadline, counts))
+        {
+            decision = scanWeights(~(query.hits | query.misses), counts.cells);
+            cache.store(key, decision);
+        }
+        else
+        {
+            decision = densityDecision(query, sunk, map);
+            if (!decision.raises)
+                decision = parityDecision(query, sunk);
+        }
+    }
+
+    int bestIndex = replayDecision(decision, rng);
+    if (bestIndex < 0)
+    {
+        // No arrangement fits the shots (the fleet is not the classic one): fall back to random fire
+        return randomUntargetedCell(tracking, rng);
+    }
+    return Position(bestIndex % BOARD_SIZE, bestIndex / BOARD_SIZE);
+}
+
+// Notes which ship a sink reported, the hits it could have covered and the cells it sank
+void ExactTargeting::recordResult(const Board &tracking, const Position &target, const ShotResult &result)
+{
+    int ship = noteSink(query, tracking, target, result);
+    if (ship >= 0)
+    {
+        const ShipKnowledge &known = query.ships[ship];
+        sinkHash = deriveSeed(sinkHash ^ known.hitsAtSink, static_cast<std::uint64_t>(ship * BOARD_SIZE * BOARD_SIZE + known.sunkCell));
+        sunk |= ProbabilityMap::sunkCells(known.sunkCell, known.length, known.hitsAtSink & ~sunk);
+    }
+}
+
+SamplingTargeting::SamplingTargeting() : query(freshArrangementQuery(CLASSIC_PLAYER_FLEET)), sunk(0) {}
+
+// Forgets the previous game
+void SamplingTargeting::reset()
+{
+    query = freshArrangementQuery(CLASSIC_PLAYER_FLEET);
+    sunk = 0;
+}
+
+// Fires at the untargeted cell occupied in the most accepted draws; ties are broken at random.
+// With too few accepted the arrangements are counted exactly, unless that runs past the move's
+// deadline: then the draws accepted decide, or the density answer if there were none.
+Position SamplingTargeting::chooseTarget(const Board &tracking, Rng &rng)
+{
+    Deadline deadline = moveDeadline();
+    query.hits = tracking.getHitCells();
+    query.misses = tracking.getMissCells();
+    Bitboard open = ~(query.hits | query.misses);
+    ArrangementCounts counts;
+    sampleArrangements(query, rng(), samplingLimits(), counts);
+    CachedDecision decision = scanWeights(open, counts.cells);
+    if (counts.total < MIN_ACCEPTED_DRAWS)
+    {
+        ArrangementCounts exact;
+        if (countArrangements(query, samplingLimits().threads, deadline, exact))
+        {
+            decision = scanWeights(open, exact.cells);
+        }
+        else if (counts.total == 0)
+        {
+            decision = densityDecision(query, sunk, map);
+            if (!decision.raises)
+                decision = parityDecision(query, sunk);
+        }
+    }
+
+    int bestIndex = replayDecision(decision, rng);
+    if (bestIndex < 0)
+    {
+        // No arrangement fits the shots (the fleet is not the classic one): fall back to random fire
+        return randomUntargetedCell(tracking, rng);
+    }
+    return Position(bestIndex % BOARD_SIZE, bestIndex / BOARD_SIZE);
+}
+
+// Notes which ship a sink reported, the hits it could have covered and the cells it sank
+void SamplingTargeting::recordResult(const Board &tracking, const Position &target, const ShotResult &result)
+{
+    int ship = noteSink(query, tracking, target, result);
+    if (ship >= 0)
+    {
+        const ShipKnowledge &known = query.ships[ship];
+        sunk |= ProbabilityMap::sunkCells(known.sunkCell, known.length, known.hitsAtSink & ~sunk);
+    }
+}
+
+AnytimeTargeting::AnytimeTargeting()
+    : query(freshArrangementQuery(CLASSIC_PLAYER_FLEET)), sunk(0), lastStage(STAGE_PARITY) {}
+
+// Forgets the previous game
+void AnytimeTargeting::reset()
+{
+    query = freshArrangementQuery(CLASSIC_PLAYER_FLEET);
+    sunk = 0;
+    lastStage = STAGE_PARITY;
+}
+
+Position AnytimeTargeting::chooseTarget(const Board &tracking, Rng &rng)
+{
+    return chooseTargetBefore(tracking, rng, moveDeadline());
+}
+
+// Refines the decision stage by stage while the deadline allows, then fires at the best cell of
+// the last stage reached; ties are broken at random
+Position AnytimeTargeting::chooseTargetBefore(const Board &tracking, Rng &rng, Deadline deadline)
+{
+    query.hits = tracking.getHitCells();
+    query.misses = tracking.getMissCells();
+    Bitboard open = ~(query.hits | query.misses);
+    std::uint64_t seed = rng();
+
+    CachedDecision decision = parityDecision(query, sunk);
+    lastStage = STAGE_PARITY;
+
+    if (std::chrono::steady_clock::now() < deadline)
+    {
+        CachedDecision density = densityDecision(query, sunk, map);
+        if (density.raises)
+        {
+            decision = density;
+            lastStage = STAGE_DENSITY;
+        }
+    }
+
+    // Sampling: whole-fleet arrangements in doubling rounds, all of them counting towards the
+    // estimate. It stops early when the full draw count of a sampling decision has been made with
+    // too few accepted, and in any case after ANYTIME_DRAW_BUDGETS of them, so a decision with no
+    // deadline ends too.
+    bool timed = deadline != Deadline::max();
+    unsigned long long perDecision = samplingLimits().draws;
+    ArrangementCounts counts = {};
+    unsigned long long made = 0;
+    unsigned int roundDraws = FIRST_ROUND_DRAWS;
+    for (std::uint64_t round = 0; counts.total < ENOUGH_ACCEPTED_DRAWS && made < perDecision * ANYTIME_DRAW_BUDGETS; round++)
+    {
+        if (made >= perDecision && counts.total < MIN_ACCEPTED_DRAWS)
+            break;
+        double milliseconds = timed ? millisecondsUntil(deadline) : 0;
+        if (timed && milliseconds <= 0)
+            break;
+        SamplingLimits limits = {roundDraws, milliseconds, samplingLimits().threads};
+        ArrangementCounts drawn;
+        made += sampleArrangements(query, deriveSeed(seed, round), limits, drawn);
+        counts.total += drawn.total;
+        for (int cell = 0; cell < BOARD_SIZE * BOARD_SIZE; cell++)
+            counts.cells[cell] += drawn.cells[cell];
+        if (roundDraws <= perDecision / 2)
+            roundDraws *= 2;
+    }
+    if (counts.total >= MIN_ACCEPTED_DRAWS)
+    {
+        CachedDecision sampled = scanWeights(open, counts.cells);
+        if (sampled.raises)
+        {
+            decision = sampled;
+            lastStage = STAGE_SAMPLING;
+        }
+    }
+    else if (std::chrono::steady_clock::now() < deadline)
+    {
+        // Too few draws fit the hits, which is when an exact count is cheap
+        ArrangementCounts exact;
+        if (countArrangements(query, samplingLimits().threads, deadline, exact))
+        {
+            CachedDecision counted = scanWeights(open, exact.cells);
+            if (counted.raises)
+            {
+                decision = counted;
+                lastStage = STAGE_EXACT;
+            }
+        }
+    }
+
+    int bestIndex = replayDecision(decision, rng);
+    if (bestIndex < 0)
+        return randomUntargetedCell(tracking, rng);
+    return Position(bestIndex % BOARD_SIZE, bestIndex / BOARD_SIZE);
+}
+
+// Notes which ship a sink reported, and the cells it sank for the parity and density stages
+void AnytimeTargeting::recordResult(const Board &tracking, const Position &target, const ShotResult &result)
+{
+    int ship = noteSink(query, tracking, target, result);
+    if (ship >= 0)
+    {
+        const ShipKnowledge &known = query.ships[ship];
+        sunk |= ProbabilityMap::sunkCells(known.sunkCell, known.length, known.hitsAtSink & ~sunk);
+    }
+}
+
+void setSamplingLimits(const SamplingLimits &limits)
+{
+    currentSamplingLimits = limits;
+}
+
+const SamplingLimits &samplingLimits()
+{
+    return currentSamplingLimits;
+}
+
+Deadline moveDeadline()
+{
+    if (currentSamplingLimits.milliseconds <= 0)
+        return Deadline::max();
+    std::chrono::duration<double, std::milli> budget(currentSamplingLimits.milliseconds);
+    return std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(budget);
+}
+
+// Creates the strategy behind kind behind the virtual interface
+std::unique_ptr<TargetingStrategy> makeTargetingStrategy(CpuStrategy kind)
+{
+    std::unique_ptr<TargetingStrategy> strategy;
+    visitStrategyType(kind, [&](auto prototype)
+                      { strategy.reset(new DynamicTargeting<decltype(prototype)>()); });
+    return strategy;
+}
+
+// Command-line name of a strategy
+std::string cpuStrategyName(CpuStrategy strategy)
+{
+    switch (strategy)
+    {
+    case CPU_RANDOM:
+        return "random";
+    case CPU_HUNT:
+        return "smart";
+    case CPU_DENSITY:
+        return "expert";
+    case CPU_EXACT:
+        return "exact";
+    case CPU_SAMPLING:
+        return "sampling";
+    case CPU_ANYTIME:
+        return "anytime";
+    default:
+        break;
+    }
+    return "unknown";
+}
+
+// Menu title of a strategy
+std::string cpuStrategyTitle(CpuStrategy strategy)
+{
+    switch (strategy)
+    {
+    case CPU_RANDOM:
+        return "Normal";
+    case CPU_HUNT:
+        return "Smart";
+    case CPU_DENSITY:
+        return "Expert";
+    case CPU_EXACT:
+        return "Perfect";
+    case CPU_SAMPLING:
+        return "Monte Carlo";
+    case CPU_ANYTIME:
+        return "Anytime";
+    default:
+        break;
+    }
+    return "Unknown";
+}
+
+// Looks up a strategy by its command-line name; returns false if the name is unknown
+bool parseCpuStrategy(const std::string &name, CpuStrategy &strategy)
+{
+    if (name == "random" || name == "normal")
+    {
+        strategy = CPU_RANDOM;
+        return true;
+    }
+    if (name == "smart" || name == "hunt")
+    {
+        strategy = CPU_HUNT;
+        return true;
+    }
+    if (name == "expert" || name == "density")
+    {
+        strategy = CPU_DENSITY;
+        return true;
+    }
+    if (name == "exact" || name == "perfect")
+    {
+        strategy = CPU_EXACT;
+        return true;
+    }
+    if (name == "sampling" || name == "montecarlo")
+    {
+        strategy = CPU_SAMPLING;
+        return true;
+    }
+    if (name == "anytime" || name == "deadline")
+    {
+        strategy = CPU_ANYTIME;
+        return true;
+    }
+    return false;
+}
\ No newline at end of file
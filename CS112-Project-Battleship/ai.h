@@ -0,0 +1,362 @@
+#ifndef AI_H
+#define AI_H
+#include "arrangements.h"
+#include "board.h"
+#include "engine.h"
+#include "fixed_vector.h"
+#include "heatmap.h"
+#include "transposition.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// CPU targeting strategies.
+// A strategy only sees the shooter's tracking board and the results of its own shots,
+// so the same code drives the console game and headless self-play.
+//
+// Every strategy is a plain class deriving from TargetingBase<Self> and providing
+//     void reset();
+//     Position chooseTarget(const Board &tracking, Rng &rng);
+//     void recordResult(const Board &tracking, const Position &target, const ShotResult &result);
+// and may also provide
+//     Position chooseTargetBefore(const Board &tracking, Rng &rng, Deadline deadline);
+// to bound its thinking time; the default ignores the deadline, which suits the strategies that
+// decide in microseconds. Templates such as the self-play runner call these directly, so they inline with no virtual
+// dispatch. The interactive game holds a TargetingStrategy, the virtual interface, which
+// DynamicTargeting<Strategy> implements for any strategy class.
+
+// available CPU strategies
+enum CpuStrategy
+{
+    CPU_RANDOM = 0, // Normal: fire at random cells
+    CPU_HUNT = 1,   // Smart: fire at random until a hit, then search around it
+    CPU_DENSITY = 2, // Expert: fire where the remaining ships fit in the most ways
+    CPU_EXACT = 3,   // Perfect: fire where the most arrangements of the whole fleet put a ship
+    CPU_SAMPLING = 4, // Monte Carlo: the same, estimated from random arrangements within a time budget
+    CPU_ANYTIME = 5,  // Anytime: refines its guess until a hard deadline, then fires at the best so far
+    CPU_STRATEGY_COUNT
+};
+
+// The moment by which a strategy must have picked its target
+typedef std::chrono::steady_clock::time_point Deadline;
+
+// Runtime-polymorphic strategy interface, used where the strategy is chosen from a menu
+class TargetingStrategy
+{
+public:
+    virtual ~TargetingStrategy() {}
+
+    virtual void reset() = 0;
+    virtual Position chooseTarget(const Board &tracking, Rng &rng) = 0;
+    virtual Position chooseTargetBefore(const Board &tracking, Rng &rng, Deadline deadline) = 0;
+    virtual void recordResult(const Board &tracking, const Position &target, const ShotResult &result) = 0;
+    // A copy in the same state, which decides exactly as this one would
+    virtual std::unique_ptr<TargetingStrategy> clone() const = 0;
+};
+
+// CRTP base of the strategy classes: default hooks for stateless strategies, and a whole
+// shot (choose, fire, learn) that resolves to the derived class at compile time
+template <class Derived>
+class TargetingBase
+{
+public:
+    void reset() {}
+    void recordResult(const Board &, const Position &, const ShotResult &) {}
+    Position chooseTargetBefore(const Board &tracking, Rng &rng, Deadline)
+    {
+        return static_cast<Derived &>(*this).chooseTarget(tracking, rng);
+    }
+
+    // Plays one shot for the side to move on engine
+    ShotResult takeShot(GameEngine &engine, Rng &rng)
+    {
+        Derived &self = static_cast<Derived &>(*this);
+        const Board &tracking = engine.getPlayer(engine.getCurrentSide()).getTrackingBoard();
+        Position target = self.chooseTarget(tracking, rng);
+        ShotResult result = engine.step(target.x, target.y);
+        self.recordResult(tracking, target, result);
+        return result;
+    }
+};
+
+// Wraps a strategy class in the virtual interface
+template <class Strategy>
+class DynamicTargeting : public TargetingStrategy
+{
+private:
+    Strategy strategy;
+
+public:
+    void reset() override { strategy.reset(); }
+    Position chooseTarget(const Board &tracking, Rng &rng) override { return strategy.chooseTarget(tracking, rng); }
+    Position chooseTargetBefore(const Board &tracking, Rng &rng, Deadline deadline) override
+    {
+        return strategy.chooseTargetBefore(tracking, rng, deadline);
+    }
+    void recordResult(const Board &tracking, const Position &target, const ShotResult &result) override
+    {
+        strategy.recordResult(tracking, target, result);
+    }
+    std::unique_ptr<TargetingStrategy> clone() const override
+    {
+        return std::unique_ptr<TargetingStrategy>(new DynamicTargeting(*this));
+    }
+};
+
+// Fires at a uniformly random cell that has not been shot yet
+class RandomTargeting : public TargetingBase<RandomTargeting>
+{
+public:
+    Position chooseTarget(const Board &tracking, Rng &rng);
+};
+
+// Fires at random until a hit, then tries the neighbours of every hit, most recent first
+class HuntTargeting : public TargetingBase<HuntTargeting>
+{
+private:
+    std::vector<Position> huntTargets;
+    bool hunting;
+
+public:
+    HuntTargeting();
+
+    void reset();
+    Position chooseTarget(const Board &tracking, Rng &rng);
+    void recordResult(const Board &tracking, const Position &target, const ShotResult &result);
+};
+
+// Per-cell placement counts for density targeting, kept up to date shot by shot.
+// It holds which placements of every ship length are still consistent with the shots so far and,
+// for each cell, how many surviving placements of the ships still afloat cover it. A miss or a
+// sink removes only the placements through the affected cells and a hit only touches the
+// placements through the hit cell, so an update costs time in proportion to what it changes
+// instead of a pass over every placement.
+class ProbabilityMap
+{
+private:
+    static const std::uint8_t REMOVED = PLACEMENT_REMOVED; // coverage of a placement that is ruled out
+
+    int shipsLeft[MAX_SHIP_LENGTH + 1];        // ships not sunk yet, by length
+    std::uint8_t coverage[PLACEMENT_TOTAL];   // unresolved hits inside each surviving placement
+    int density[BOARD_SIZE * BOARD_SIZE];     // surviving placements of the remaining ships over each cell
+    int hitDensity[BOARD_SIZE * BOARD_SIZE];  // the same, each placement weighted by the unresolved hits it covers
+    Bitboard shot;                            // cells fired at
+    Bitboard blocked;                         // misses and cells of sunk ships
+    Bitboard unresolved;                      // hits not attributed to a sunk ship
+
+    void removePlacement(int index);
+    void block(int cell);
+
+public:
+    ProbabilityMap();
+
+    void reset(const Fleet &fleet);
+    // Counts everything again from the ships left of each length, the misses and sunk cells
+    // (blocked) and the hits not yet attributed to a sunk ship (unresolved)
+    void recount(const int ships[MAX_SHIP_LENGTH + 1], Bitboard blockedCells, Bitboard unresolvedHits);
+    void miss(int cell);
+    void hit(int cell);
+    // A hit (already passed to hit) sank a ship of the given length; its cells are attributed
+    // where every candidate position of the ship agrees, otherwise just the sinking cell
+    void sink(int cell, int length);
+    // The cells sink attributes to a ship of length sunk at cell, given the unresolved hits
+    static Bitboard sunkCells(int cell, int length, Bitboard unresolved);
+
+    // Weight of each cell: while a ship is wounded only placements through unresolved hits count
+    const int *getWeights() const { return unresolved ? hitDensity : density; }
+    Bitboard getShotCells() const { return shot; }
+};
+
+// Probability-density targeting: for every remaining ship length, counts each placement that is
+// consistent with the known hits and misses, then fires at the cell covered by the most placements.
+// Placements through unresolved hits (hits not yet explained by a sunk ship) are weighted heavily,
+// so after a hit the search concentrates on finishing that ship. The counts live in a
+// ProbabilityMap that each result updates incrementally.
+//
+// Decisions are shared through TranspositionCache::densityDecisions(), keyed by the tracking
+// board's Zobrist hash together with the ships sunk so far, which is everything the counts depend
+// on. Results are queued rather than applied, and the map only catches up when a position is not
+// in the cache, so the common opening positions of self-play cost a lookup each. A strategy
+// constructed without a cache counts every decision.
+class DensityTargeting : public TargetingBase<DensityTargeting>
+{
+private:
+    // A shot the map has not been told about yet
+    struct PendingShot
+    {
+        std::uint8_t cell;
+        std::uint8_t outcome; // SHOT_MISS, SHOT_HIT or SHOT_SUNK
+        std::uint8_t length;  // length of the ship sunk
+    };
+
+    ProbabilityMap map;
+    FixedVector<PendingShot, BOARD_SIZE * BOARD_SIZE> pending;
+    Bitboard queued;          // cells fired at, whether applied to the map or still pending
+    Bitboard queuedHits;      // the hits among them
+    Bitboard sunk;            // cells attributed to sunk ships
+    std::uint64_t sunkHash;   // Zobrist hash of the sunk cells
+    std::uint64_t sunkCounts; // ships sunk by length, 4 bits per length
+    TranspositionCache *decisions; // cache shared with other strategies, or null
+
+    void queue(int cell, ShotOutcome outcome, int length);
+    void queueUnseen(const Board &tracking, Bitboard skip);
+    void catchUp();
+
+public:
+    explicit DensityTargeting(TranspositionCache *decisions = &TranspositionCache::densityDecisions());
+
+    void reset();
+    Position chooseTarget(const Board &tracking, Rng &rng);
+    void recordResult(const Board &tracking, const Position &target, const ShotResult &result);
+};
+
+// Exact targeting: counts every arrangement of the whole enemy fleet consistent with the shots and
+// the ships reported sunk (see arrangements.h) and fires at the cell that holds a ship in the most
+// of them, which is the cell most likely to be a hit. Unlike density targeting, ships cannot
+// overlap and a sunk ship is pinned to the hits it could have occupied.
+//
+// Decisions are shared through TranspositionCache::exactDecisions(), keyed by the tracking board's
+// hash and the sinks reported, so positions every game reaches (the empty board first of all) are
+// only counted once. The count runs on samplingLimits().threads threads.
+//
+// chooseTarget counts however long it takes. chooseTargetBefore gives up a count still running at
+// its deadline and fires at the density targeting answer instead, so a move given a deadline only
+// matches the move without one if the count finished (or was cached).
+class ExactTargeting : public TargetingBase<ExactTargeting>
+{
+private:
+    ArrangementQuery query; // its hits and misses are refreshed from the tracking board
+    std::uint64_t sinkHash; // hash of the sinks reported so far
+    Bitboard sunk;          // cells attributed to sunk ships, for the fallback
+    ProbabilityMap map;     // recounted for the fallback
+
+public:
+    ExactTargeting();
+
+    void reset();
+    Position chooseTarget(const Board &tracking, Rng &rng);
+    Position chooseTargetBefore(const Board &tracking, Rng &rng, Deadline deadline);
+    void recordResult(const Board &tracking, const Position &target, const ShotResult &result);
+};
+
+// Monte Carlo targeting: draws random arrangements of the whole enemy fleet that agree with the
+// shots (see sampleArrangements) and fires at the cell occupied in the most of them. It estimates
+// what ExactTargeting counts at a bounded cost per decision: the draws stop at samplingLimits(),
+// whichever of the draw count and the time budget comes first. Draws are seeded from the
+// strategy's generator, so a decision that finishes its draws is reproducible.
+// Hits make most draws miss them; when too few draws are accepted the strategy counts exactly
+// instead. Late in a game that count is cheap, but early on it can take far longer than the
+// budget, so it is abandoned at moveDeadline() for the few draws accepted, or for the density
+// answer if none were.
+class SamplingTargeting : public TargetingBase<SamplingTargeting>
+{
+private:
+    ArrangementQuery query; // its hits and misses are refreshed from the tracking board
+    Bitboard sunk;          // cells attributed to sunk ships, for the fallback
+    ProbabilityMap map;     // recounted for the fallback
+
+public:
+    SamplingTargeting();
+
+    void reset();
+    Position chooseTarget(const Board &tracking, Rng &rng);
+    void recordResult(const Board &tracking, const Position &target, const ShotResult &result);
+};
+
+// Anytime targeting: always has an answer and improves it in stages until its deadline passes,
+// then fires at the best answer found so far, so a move never takes much longer than the budget
+// however hard the position is:
+//   1. parity: the neighbours of unresolved hits, else the cells of a checkerboard spaced by the
+//      shortest ship afloat, which every remaining ship must cross;
+//   2. density: placements of each remaining ship counted on their own, as density targeting does;
+//   3. sampling: random arrangements of the whole fleet, drawn in growing rounds until enough are
+//      accepted or the deadline passes (the rounds of a decision cut short still count);
+//   4. exact: when the hits leave too few draws accepted, the arrangements counted as exact
+//      targeting counts them, unless the deadline passes first.
+// Sampling stops after a bounded number of draws even without a deadline.
+// chooseTarget uses moveDeadline(). The result depends on how far the refinement got, so only a
+// decision that finishes its draws before the deadline is reproducible.
+class AnytimeTargeting : public TargetingBase<AnytimeTargeting>
+{
+public:
+    enum Stage
+    {
+        STAGE_PARITY,
+        STAGE_DENSITY,
+        STAGE_SAMPLING,
+        STAGE_EXACT,
+        STAGE_COUNT
+    };
+
+private:
+    ArrangementQuery query; // its hits and misses are refreshed from the tracking board
+    ProbabilityMap map;     // recounted for the density stage
+    Bitboard sunk;          // cells attributed to sunk ships
+    Stage lastStage;        // stage whose answer the last decision fired at
+
+public:
+    AnytimeTargeting();
+
+    void reset();
+    Position chooseTarget(const Board &tracking, Rng &rng);
+    Position chooseTargetBefore(const Board &tracking, Rng &rng, Deadline deadline);
+    void recordResult(const Board &tracking, const Position &target, const ShotResult &result);
+
+    Stage getLastStage() const { return lastStage; }
+};
+
+// Limits of every SamplingTargeting decision (default: 200000 draws, 100 ms, all cores). The time
+// limit is also the budget of each AnytimeTargeting move and of every CPU move of the console game,
+// and the thread count is that of every exact count and estimate a strategy makes. Modes that play
+// games on several threads of their own set it to 1, so that only the console CPU splits its
+// decisions across cores. Set them before any game starts; they are read without locking.
+void setSamplingLimits(const SamplingLimits &limits);
+const SamplingLimits &samplingLimits();
+// The deadline of a CPU move that starts now
+Deadline moveDeadline();
+
+// Picks a uniformly random cell that holds neither a hit nor a miss on the tracking board
+Position randomUntargetedCell(const Board &tracking, Rng &rng);
+// Returns the on-board orthogonal neighbours of (x, y)
+std::vector<Position> getAdjacentPositions(int x, int y);
+
+// Calls visit(Strategy()) with a default-constructed object of the class behind kind.
+// This is the one place that maps CpuStrategy values to classes; templates use it to
+// instantiate themselves for the chosen strategy.
+template <class Visitor>
+void visitStrategyType(CpuStrategy kind, Visitor &&visit)
+{
+    switch (kind)
+    {
+    case CPU_HUNT:
+        visit(HuntTargeting());
+        break;
+    case CPU_DENSITY:
+        visit(DensityTargeting());
+        break;
+    case CPU_EXACT:
+        visit(ExactTargeting());
+        break;
+    case CPU_SAMPLING:
+        visit(SamplingTargeting());
+        break;
+    case CPU_ANYTIME:
+        visit(AnytimeTargeting());
+        break;
+    default:
+        visit(RandomTargeting());
+        break;
+    }
+}
+
+// Creates the strategy behind kind behind the virtual interface
+std::unique_ptr<TargetingStrategy> makeTargetingStrategy(CpuStrategy kind);
+
+// Command-line name of a strategy, its menu title, and the reverse lookup
+std::string cpuStrategyName(CpuStrategy strategy);
+std::string cpuStrategyTitle(CpuStrategy strategy);
+bool parseCpuStrategy(const std::string &name, CpuStrategy &strategy);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,496 @@
+#include "arrangements.h"
+#include "placements.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const int CELLS = BOARD_SIZE * BOARD_SIZE;
+    // Independent generator streams a Monte Carlo estimate is split into
+    const int SAMPLING_STREAMS = 16;
+    // Draws between two looks at the clock
+    const unsigned int CLOCK_INTERVAL = 64;
+    // A ship that starts at or before the cursor ends at most this many cells past it, so the cells
+    // claimed ahead of the cursor fit in the low bits of a state key, below the ships used
+    const int USED_SHIFT = 40;
+    const std::uint64_t CLAIMED_MASK = (std::uint64_t(1) << USED_SHIFT) - 1;
+    static_assert((MAX_SHIP_LENGTH - 1) * BOARD_SIZE < USED_SHIFT, "claimed cells must fit below the used ships");
+
+    // A candidate placement of one ship, filed under its first cell in row-major order
+    struct Start
+    {
+        int ship;
+        int ordinal; // position among the ship's candidates
+        Bitboard mask;
+    };
+
+    struct Sweep
+    {
+        Bitboard hits;
+        std::uint64_t fleetUsed; // used bits once every ship is placed
+        std::vector<Start> starts[CELLS];
+        std::uint64_t overdue[CELLS + 1]; // ships with no candidate starting at or after each cell
+    };
+
+    // Threads kept for splitting one count or estimate, so a decision does not start threads of
+    // its own. They are started on first use, one fewer than the hardware threads since the caller
+    // works too, and left waiting when the program exits. The pool runs one job at a time: a caller
+    // that finds it busy (a second decision made at the same moment) does its shares itself.
+    class SharePool
+    {
+    private:
+        std::mutex busy; // held by the caller whose job the pool is running
+        std::mutex lock;
+        std::condition_variable posted;
+        std::condition_variable finished;
+        const std::function<void(int)> *job; // null between jobs
+        int shares;
+        int nextShare;
+        int unfinished;
+
+        // Runs shares of the current job until none is left to take; lock is held on entry and exit
+        void work(std::unique_lock<std::mutex> &guard)
+        {
+            while (job && nextShare < shares)
+            {
+                int share = nextShare++;
+                const std::function<void(int)> &current = *job;
+                guard.unlock();
+                current(share);
+                guard.lock();
+                if (--unfinished == 0)
+                    finished.notify_all();
+            }
+        }
+
+        void serve()
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            for (;;)
+            {
+                posted.wait(guard, [&]()
+                            { return job && nextShare < shares; });
+                work(guard);
+            }
+        }
+
+    public:
+        explicit SharePool(unsigned int helpers) : job(nullptr), shares(0), nextShare(0), unfinished(0)
+        {
+            for (unsigned int i = 0; i < helpers; i++)
+                std::thread([this]()
+                            { serve(); })
+                    .detach();
+        }
+
+        // Runs work(0) .. work(count - 1) on the pool's threads and the caller's, and returns once
+        // all of them have
+        void run(int count, const std::function<void(int)> &work)
+        {
+            std::unique_lock<std::mutex> owner(busy, std::try_to_lock);
+            if (!owner.owns_lock())
+            {
+                for (int share = 0; share < count; share++)
+                    work(share);
+                return;
+            }
+            std::unique_lock<std::mutex> guard(lock);
+            job = &work;
+            shares = count;
+            nextShare = 0;
+            unfinished = count;
+            posted.notify_all();
+            this->work(guard);
+            finished.wait(guard, [&]()
+                          { return unfinished == 0; });
+            job = nullptr;
+        }
+    };
+
+    // Runs work(0) .. work(count - 1), on the pool when there is more than one share. A job of one
+    // share (every decision of a simulation, script or replay) runs on the caller alone and never
+    // starts the pool.
+    void runShares(int count, const std::function<void(int)> &work)
+    {
+        if (count <= 1)
+        {
+            for (int share = 0; share < count; share++)
+                work(share);
+            return;
+        }
+        static SharePool *pool = nullptr;
+        static std::once_flag started;
+        std::call_once(started, []()
+                       {
+            unsigned int hardware = std::thread::hardware_concurrency();
+            pool = new SharePool(hardware > 1 ? hardware - 1 : 0); });
+        pool->run(count, work);
+    }
+
+    // Threads to split a job into when the caller asks for threads (0 = one per hardware thread)
+    unsigned int resolveThreads(unsigned int threads)
+    {
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+        return threads == 0 ? 1 : threads;
+    }
+
+    // Placements of a ship that agree with the shots: none on a miss, and for a sunk ship only hit
+    // cells that were hit when it sank, including the sinking cell; a ship afloat keeps an unhit cell
+    std::vector<Bitboard> shipCandidates(const ArrangementQuery &query, int ship)
+    {
+        std::vector<Bitboard> candidates;
+        const ShipKnowledge &known = query.ships[ship];
+        if (known.length < 1 || known.length > MAX_SHIP_LENGTH)
+            return candidates;
+        for (int p = placementsBegin(known.length); p < placementsEnd(known.length); p++)
+        {
+            Bitboard mask = PLACEMENTS[p].mask;
+            if (mask & query.misses)
+                continue;
+            if (known.sunk ? (mask & ~known.hitsAtSink) || !(mask & cellBit(known.sunkCell)) : !(mask & ~query.hits))
+                continue;
+            candidates.push_back(mask);
+        }
+        return candidates;
+    }
+
+    // A state of the sweep on one cell
+    struct SweepState
+    {
+        std::uint64_t key;         // cells claimed from the cursor on (bit 0 = the cursor) and the ships used
+        std::uint64_t ways;        // ways to reach it from the first cell
+        std::uint64_t completions; // ways to place the rest of the fleet from it
+        std::uint32_t firstMove;   // its moves in the layer's move list
+        std::uint32_t endMove;
+    };
+
+    // A move to a state of the next layer
+    struct Move
+    {
+        std::uint32_t to;
+        bool water;
+    };
+
+    // The states the sweep reaches on one cell, and the moves out of them
+    struct Layer
+    {
+        std::vector<SweepState> states;
+        std::vector<Move> moves;
+    };
+
+    // Finds the states of the layer being built by key: open addressing over state indices,
+    // emptied between layers by bumping a generation number instead of clearing the table
+    class StateIndex
+    {
+    private:
+        struct Slot
+        {
+            std::uint32_t generation;
+            std::uint32_t state;
+        };
+        std::vector<Slot> slots;
+        std::uint32_t generation;
+        std::size_t used;
+
+        static std::size_t hash(std::uint64_t key) { return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ULL) >> 32); }
+
+        void grow(const std::vector<SweepState> &states)
+        {
+            std::vector<Slot> old;
+            old.swap(slots);
+            slots.assign(old.empty() ? 1024 : old.size() * 2, Slot{0, 0});
+            for (const Slot &slot : old)
+            {
+                if (slot.generation != generation)
+                    continue;
+                std::size_t i = hash(states[slot.state].key) & (slots.size() - 1);
+                while (slots[i].generation == generation)
+                    i = (i + 1) & (slots.size() - 1);
+                slots[i] = slot;
+            }
+        }
+
+    public:
+        StateIndex() : generation(0), used(0) {}
+
+        void clear()
+        {
+            generation++;
+            used = 0;
+        }
+
+        // Index of the state with key in states, appended if it is not there yet
+        std::uint32_t find(std::uint64_t key, std::vector<SweepState> &states)
+        {
+            if (2 * (used + 1) > slots.size())
+                grow(states);
+            std::size_t i = hash(key) & (slots.size() - 1);
+            while (slots[i].generation == generation)
+            {
+                if (states[slots[i].state].key == key)
+                    return slots[i].state;
+                i = (i + 1) & (slots.size() - 1);
+            }
+            slots[i] = Slot{generation, static_cast<std::uint32_t>(states.size())};
+            used++;
+            states.push_back(SweepState{key, 0, 0, 0, 0});
+            return slots[i].state;
+        }
+    };
+
+    // Calls visit(next key, water) for every way to move the cursor past cell from a state: step
+    // over a claimed cell, leave the cell as water (not on a hit), or start an unused ship there.
+    // The first ship may only take the candidates whose ordinal is share modulo stride.
+    template <class Visitor>
+    void forEachMove(const Sweep &sweep, int cell, std::uint64_t key, int share, int stride, Visitor &&visit)
+    {
+        std::uint64_t claimed = key & CLAIMED_MASK;
+        std::uint64_t used = key >> USED_SHIFT;
+        if (sweep.overdue[cell] & ~used)
+            return; // a ship can no longer be placed
+        if (claimed & 1)
+        {
+            visit(claimed >> 1 | used << USED_SHIFT, false);
+            return;
+        }
+        if (!(sweep.hits & cellBit(cell)))
+            visit(claimed >> 1 | used << USED_SHIFT, true);
+        for (const Start &start : sweep.starts[cell])
+        {
+            std::uint64_t bit = std::uint64_t(1) << start.ship;
+            std::uint64_t ahead = start.mask >> cell;
+            if ((used & bit) || (claimed & ahead) || (start.ship == 0 && start.ordinal % stride != share))
+                continue;
+            visit((claimed | ahead) >> 1 | (used | bit) << USED_SHIFT, false);
+        }
+    }
+
+    // Counts the arrangements in which the first ship takes its share of the candidates, adding
+    // them to counts. Gives up and returns false if deadline passes first (the clock is read once
+    // per cell of each pass).
+    bool sweepShare(const Sweep &sweep, int share, int stride, std::chrono::steady_clock::time_point deadline,
+                    ArrangementCounts &counts)
+    {
+        bool timed = deadline != std::chrono::steady_clock::time_point::max();
+
+        // Forward: how many ways reach each state, cell by cell, noting the moves between them
+        std::vector<Layer> layers(CELLS + 1);
+        StateIndex index;
+        layers[0].states.push_back(SweepState{0, 1, 0, 0, 0});
+        for (int cell = 0; cell < CELLS; cell++)
+        {
+            if (timed && std::chrono::steady_clock::now() >= deadline)
+                return false;
+            Layer &here = layers[cell];
+            std::vector<SweepState> &next = layers[cell + 1].states;
+            index.clear();
+            for (SweepState &state : here.states)
+            {
+                state.firstMove = static_cast<std::uint32_t>(here.moves.size());
+                forEachMove(sweep, cell, state.key, share, stride, [&](std::uint64_t key, bool water)
+                            {
+                    std::uint32_t to = index.find(key, next);
+                    next[to].ways += state.ways;
+                    here.moves.push_back(Move{to, water}); });
+                state.endMove = static_cast<std::uint32_t>(here.moves.size());
+            }
+        }
+
+        // Backward: how many ways finish from each state. A cell holds a ship in every arrangement
+        // through its layer except those that leave it as water.
+        for (SweepState &state : layers[CELLS].states)
+            state.completions = state.key == sweep.fleetUsed << USED_SHIFT ? 1 : 0;
+        for (int cell = CELLS - 1; cell >= 0; cell--)
+        {
+            if (timed && std::chrono::steady_clock::now() >= deadline)
+                return false;
+            Layer &here = layers[cell];
+            const std::vector<SweepState> &next = layers[cell + 1].states;
+            std::uint64_t through = 0, water = 0;
+            for (SweepState &state : here.states)
+            {
+                for (std::uint32_t m = state.firstMove; m < state.endMove; m++)
+                {
+                    std::uint64_t finish = next[here.moves[m].to].completions;
+                    state.completions += finish;
+                    if (here.moves[m].water)
+                        water += state.ways * finish;
+                }
+                through += state.ways * state.completions;
+            }
+            counts.cells[cell] += through - water;
+        }
+        counts.total += layers[0].states[0].completions;
+        return true;
+    }
+
+    // Candidate placements of every ship, fewest first so that overlaps reject a draw early
+    struct SampleSpace
+    {
+        Bitboard hits;
+        std::vector<std::vector<Bitboard>> candidates; // one list per ship
+    };
+
+    // Draws one arrangement; returns false if it is rejected
+    bool drawArrangement(const SampleSpace &space, Rng &rng, Bitboard &occupied)
+    {
+        occupied = 0;
+        for (const std::vector<Bitboard> &candidates : space.candidates)
+        {
+            Bitboard mask = candidates[rng.below(static_cast<std::uint32_t>(candidates.size()))];
+            if (mask & occupied)
+                return false;
+            occupied |= mask;
+        }
+        return !(space.hits & ~occupied);
+    }
+
+    // Makes up to draws draws from one stream into counts, stopping at the deadline if there is
+    // one; returns the draws made
+    unsigned long long sampleStream(const SampleSpace &space, std::uint64_t seed, unsigned long long draws, bool timed,
+                                    std::chrono::steady_clock::time_point deadline, ArrangementCounts &counts)
+    {
+        Rng rng(seed);
+        unsigned long long made = 0;
+        for (; made < draws; made++)
+        {
+            if (timed && made % CLOCK_INTERVAL == 0 && std::chrono::steady_clock::now() >= deadline)
+                break;
+            Bitboard occupied;
+            if (!drawArrangement(space, rng, occupied))
+                continue;
+            counts.total++;
+            for (; occupied; clearLowestCell(occupied))
+                counts.cells[lowestCell(occupied)]++;
+        }
+        return made;
+    }
+}
+
+// The query of a fleet with no ships sunk, before any shot is taken
+ArrangementQuery freshArrangementQuery(const Fleet &fleet)
+{
+    ArrangementQuery query;
+    query.hits = 0;
+    query.misses = 0;
+    query.shipCount = fleet.size < FLEET_SIZE ? fleet.size : FLEET_SIZE;
+    for (int i = 0; i < query.shipCount; i++)
+        query.ships[i] = ShipKnowledge{fleet.ships[i].length, false, 0, 0};
+    return query;
+}
+
+void countArrangements(const ArrangementQuery &query, unsigned int threads, ArrangementCounts &counts)
+{
+    countArrangements(query, threads, std::chrono::steady_clock::time_point::max(), counts);
+}
+
+bool countArrangements(const ArrangementQuery &query, unsigned int threads,
+                       std::chrono::steady_clock::time_point deadline, ArrangementCounts &counts)
+{
+    std::memset(&counts, 0, sizeof(counts));
+    if (query.shipCount <= 0)
+        return true;
+
+    Sweep sweep;
+    sweep.hits = query.hits;
+    sweep.fleetUsed = (std::uint64_t(1) << query.shipCount) - 1;
+    int firstCandidates = 0;
+    for (int ship = 0; ship < query.shipCount; ship++)
+    {
+        std::vector<Bitboard> candidates = shipCandidates(query, ship);
+        if (candidates.empty())
+            return true;
+        for (std::size_t i = 0; i < candidates.size(); i++)
+            sweep.starts[lowestCell(candidates[i])].push_back(Start{ship, static_cast<int>(i), candidates[i]});
+        if (ship == 0)
+            firstCandidates = static_cast<int>(candidates.size());
+    }
+    std::uint64_t pending = 0;
+    for (int cell = CELLS; cell >= 0; cell--)
+    {
+        sweep.overdue[cell] = sweep.fleetUsed & ~pending;
+        if (cell > 0)
+            for (const Start &start : sweep.starts[cell - 1])
+                pending |= std::uint64_t(1) << start.ship;
+    }
+
+    threads = resolveThreads(threads);
+    if (threads > static_cast<unsigned int>(firstCandidates))
+        threads = static_cast<unsigned int>(firstCandidates);
+
+    // Each share of the first ship's placements is swept with its own states into its own counts
+    std::vector<ArrangementCounts> shares(threads);
+    std::memset(shares.data(), 0, shares.size() * sizeof(ArrangementCounts));
+    std::atomic<bool> finished(true);
+    runShares(static_cast<int>(threads), [&](int share)
+              {
+        if (!finished.load() || !sweepShare(sweep, share, static_cast<int>(threads), deadline, shares[share]))
+            finished.store(false); });
+    if (!finished.load())
+        return false;
+
+    for (const ArrangementCounts &share : shares)
+    {
+        counts.total += share.total;
+        for (int cell = 0; cell < CELLS; cell++)
+            counts.cells[cell] += share.cells[cell];
+    }
+    return true;
+}
+
+unsigned long long sampleArrangements(const ArrangementQuery &query, std::uint64_t seed, const SamplingLimits &limits,
+                                      ArrangementCounts &counts)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::memset(&counts, 0, sizeof(counts));
+    SampleSpace space;
+    space.hits = query.hits;
+    for (int ship = 0; ship < query.shipCount; ship++)
+    {
+        space.candidates.push_back(shipCandidates(query, ship));
+        if (space.candidates.back().empty())
+            return 0;
+    }
+    std::sort(space.candidates.begin(), space.candidates.end(), [](const std::vector<Bitboard> &a, const std::vector<Bitboard> &b)
+              { return a.size() < b.size(); });
+
+    bool timed = limits.milliseconds > 0;
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                std::chrono::duration<double, std::milli>(limits.milliseconds));
+    unsigned int threads = resolveThreads(limits.threads);
+    if (threads > static_cast<unsigned int>(SAMPLING_STREAMS))
+        threads = SAMPLING_STREAMS;
+
+    // Stream i makes its share of the draws from its own generator, whichever thread runs it
+    ArrangementCounts streams[SAMPLING_STREAMS];
+    unsigned long long made[SAMPLING_STREAMS] = {0};
+    std::memset(streams, 0, sizeof(streams));
+    std::atomic<int> next(0);
+    runShares(static_cast<int>(threads), [&](int)
+              {
+        for (int i = next++; i < SAMPLING_STREAMS; i = next++)
+        {
+            unsigned long long draws = (static_cast<unsigned long long>(limits.draws) * (i + 1)) / SAMPLING_STREAMS -
+                                       (static_cast<unsigned long long>(limits.draws) * i) / SAMPLING_STREAMS;
+            made[i] = sampleStream(space, deriveSeed(seed, i), draws, timed, deadline, streams[i]);
+        } });
+
+    unsigned long long total = 0;
+    for (int i = 0; i < SAMPLING_STREAMS; i++)
+    {
+        total += made[i];
+        counts.total += streams[i].total;
+        for (int cell = 0; cell < CELLS; cell++)
+            counts.cells[cell] += streams[i].cells[cell];
+    }
+    return total;
+}
@@ -0,0 +1,80 @@
+#ifndef ARRANGEMENTS_H
+#define ARRANGEMENTS_H
+#include "board.h"
+#include <chrono>
+#include <cstdint>
+
+// Exact counting of the ways the enemy fleet can lie on the board.
+// The placement densities of the expert CPU count each ship on its own, so they also count
+// placements that overlap another ship. This solver counts whole arrangements instead: one
+// placement per ship of the fleet, no two overlapping, no ship on a miss, every hit covered, and
+// each ship sunk or afloat exactly as the shots so far reported. Dividing a cell's count by the
+// total gives the exact probability that a ship lies there.
+//
+// The count sweeps the cells in row-major order. At each cell an arrangement either steps over a
+// cell claimed by a ship placed earlier, leaves it as water, or starts an unused ship there, so a
+// memoised state is the cursor, the ships used and the cells claimed ahead of it (a bitmask of
+// the next few rows). A forward pass counts the ways to reach each state, a backward pass the
+// ways to finish from it, and a cell holds a ship in every arrangement but those that leave it as
+// water. The first ship's placements are shared out among worker threads, each sweeping with its
+// own states, and the per-thread totals are merged at the end. Counts are exact integers, so the
+// result does not depend on the thread count. The worker threads are a pool started by the first
+// count or estimate asked to use more than one thread, and kept for the rest of the program, so a
+// count or estimate does not start threads itself; on one thread no pool is started at all.
+
+// What the shooter knows about one ship of the enemy fleet
+struct ShipKnowledge
+{
+    int length;
+    bool sunk;
+    int sunkCell;        // cell of the shot that sank it
+    Bitboard hitsAtSink; // every hit on the board right after that shot
+};
+
+// A shooter's view of the enemy fleet: its shots and which ship each sink reported
+struct ArrangementQuery
+{
+    Bitboard hits;
+    Bitboard misses;
+    int shipCount;
+    ShipKnowledge ships[FLEET_SIZE];
+};
+
+struct ArrangementCounts
+{
+    std::uint64_t total;                          // consistent arrangements of the whole fleet
+    std::uint64_t cells[BOARD_SIZE * BOARD_SIZE]; // those with a ship on each cell
+};
+
+// Limits of a Monte Carlo estimate
+struct SamplingLimits
+{
+    unsigned int draws;  // random arrangements to draw in all
+    double milliseconds; // stop drawing once this much time has passed; 0 = no time limit
+    unsigned int threads; // threads per count or estimate, 0 = one per hardware thread
+};
+
+// The query of a fleet with no ships sunk, before any shot is taken
+ArrangementQuery freshArrangementQuery(const Fleet &fleet);
+
+// Counts the arrangements consistent with query on the given number of threads (0 = one per
+// hardware thread). A total of 0 means the query contradicts itself.
+void countArrangements(const ArrangementQuery &query, unsigned int threads, ArrangementCounts &counts);
+// The same count, abandoned if it is still running at deadline: returns false, with counts left
+// at zero, if it was
+bool countArrangements(const ArrangementQuery &query, unsigned int threads,
+                       std::chrono::steady_clock::time_point deadline, ArrangementCounts &counts);
+
+// Estimates the same counts by drawing random arrangements: every ship takes a uniformly random
+// placement that avoids the misses (as placeRandomShips would, with the shots as constraints), and
+// a draw is rejected as soon as two ships overlap or if it leaves a hit uncovered, so the accepted
+// draws are uniform over the consistent arrangements. counts.total is the number accepted.
+//
+// The draws are split into a fixed number of streams, each with its own generator derived from
+// seed, which worker threads take in turn. Unless the time limit cuts them short the estimate
+// therefore depends only on seed and limits.draws, not on the thread count. Returns the number of
+// draws made.
+unsigned long long sampleArrangements(const ArrangementQuery &query, std::uint64_t seed, const SamplingLimits &limits,
+                                      ArrangementCounts &counts);
+
+#endif
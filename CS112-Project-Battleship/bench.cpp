@@ -0,0 +1,417 @@
+// Micro-benchmarks for the Board and CPU hot paths.
+// Build: g++ -O2 bench.cpp board.cpp player.cpp engine.cpp ai.cpp heatmap.cpp arrangements.cpp render.cpp record.cpp -o bench -pthread
+// Run:   ./bench          (table)
+//        ./bench --json   (machine-readable, for comparing releases)
+#include "board.h"
+#include "player.h"
+#include "engine.h"
+#include "ai.h"
+#include "arrangements.h"
+#include "heatmap.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+// Every heap allocation in the process goes through these, so a benchmark can report allocations per op
+static std::atomic<unsigned long long> allocationCount(0);
+
+void *operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+    const double MIN_SECONDS = 0.2; // each benchmark runs at least this long
+
+    struct BenchResult
+    {
+        std::string name;
+        unsigned long long ops;
+        double nsPerOp;
+        double allocsPerOp;
+    };
+
+    volatile long long sink; // keeps results observable so the optimiser cannot drop the work
+
+    // Runs body (which performs opsPerCall operations) until MIN_SECONDS have passed
+    template <class Body>
+    BenchResult measure(const std::string &name, unsigned long long opsPerCall, Body body)
+    {
+        body(); // warm-up
+        unsigned long long calls = 0;
+        unsigned long long allocsBefore = allocationCount.load();
+        auto start = std::chrono::steady_clock::now();
+        double elapsed = 0;
+        for (unsigned long long batch = 1; elapsed < MIN_SECONDS; batch *= 2)
+        {
+            for (unsigned long long i = 0; i < batch; i++)
+                body();
+            calls += batch;
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        unsigned long long allocs = allocationCount.load() - allocsBefore;
+
+        BenchResult result;
+        result.name = name;
+        result.ops = calls * opsPerCall;
+        result.nsPerOp = elapsed * 1e9 / result.ops;
+        result.allocsPerOp = static_cast<double>(allocs) / result.ops;
+        return result;
+    }
+
+    // Tracking boards captured from self-play games, used as realistic CPU decision inputs
+    struct DecisionInput
+    {
+        Board tracking;
+        ShotResult lastResult;
+        Position lastTarget;
+    };
+
+    std::vector<DecisionInput> captureSnapshots(int games, Rng &rng)
+    {
+        std::vector<DecisionInput> snapshots;
+        GameEngine engine("First", "Second");
+        HuntTargeting ai;
+        for (int g = 0; g < games; g++)
+        {
+            engine.reset();
+            ai.reset();
+            engine.getPlayer(FIRST_SIDE).getOwnBoard().placeRandomShips(false, rng);
+            engine.getPlayer(SECOND_SIDE).getOwnBoard().placeRandomShips(true, rng);
+            while (!engine.isGameOver())
+            {
+                const Board &tracking = engine.getPlayer(FIRST_SIDE).getTrackingBoard();
+                Position target = ai.chooseTarget(tracking, rng);
+                ShotResult result = engine.fire(FIRST_SIDE, target.x, target.y);
+                ai.recordResult(tracking, target, result);
+                DecisionInput snapshot = {tracking, result, target};
+                snapshots.push_back(snapshot);
+            }
+        }
+        return snapshots;
+    }
+
+    // Replays each snapshot's last result into a copy of prototype and times the next decision
+    template <class Strategy>
+    BenchResult measureDecision(const std::string &name, const std::vector<DecisionInput> &snapshots, Rng &rng,
+                                const Strategy &prototype = Strategy())
+    {
+        return measure(name, snapshots.size(), [&]()
+                       {
+            Strategy ai = prototype;
+            long long total = 0;
+            for (const auto &s : snapshots)
+            {
+                ai.reset();
+                ai.recordResult(s.tracking, s.lastTarget, s.lastResult);
+                Position p = ai.chooseTarget(s.tracking, rng);
+                total += p.x + p.y;
+            }
+            sink = total; });
+    }
+
+    // Times whole self-play games, so strategies that learn from every result are measured with their updates
+    template <class Strategy>
+    BenchResult measureGame(const std::string &name, Rng &rng)
+    {
+        GameEngine engine("First", "Second");
+        Strategy first, second;
+        return measure(name, 1, [&]()
+                       {
+            engine.reset();
+            first.reset();
+            second.reset();
+            engine.getPlayer(FIRST_SIDE).getOwnBoard().placeRandomShips(false, rng);
+            engine.getPlayer(SECOND_SIDE).getOwnBoard().placeRandomShips(true, rng);
+            while (!engine.isGameOver())
+            {
+                if (engine.getCurrentSide() == FIRST_SIDE)
+                    first.takeShot(engine, rng);
+                else
+                    second.takeShot(engine, rng);
+            }
+            sink = engine.getWinner(); });
+    }
+
+    // Per-cell counts of every placement on one snapshot, as the counting kernels produce them
+    struct HeatmapCounts
+    {
+        std::uint8_t coverage[PLACEMENT_TOTAL];
+        int cover[BOARD_SIZE * BOARD_SIZE];
+        int hitCover[BOARD_SIZE * BOARD_SIZE];
+    };
+
+    void countSnapshot(CountingKernel kernel, const Board &tracking, HeatmapCounts &counts)
+    {
+        for (int cell = 0; cell < BOARD_SIZE * BOARD_SIZE; cell++)
+        {
+            counts.cover[cell] = 0;
+            counts.hitCover[cell] = 0;
+        }
+        // every length weighs its length, so each group contributes differently
+        static const int WEIGHTS[MAX_SHIP_LENGTH + 1] = {0, 1, 2, 3, 4, 5};
+        countPlacementsWith(kernel, PLACEMENTS.data(), PLACEMENT_TOTAL, tracking.getMissCells(), tracking.getHitCells(),
+                            WEIGHTS, counts.coverage, counts.cover, counts.hitCover);
+    }
+
+    // Plays one game on a Width x Height board with the classic fleets, each side firing at every
+    // cell in order; true if it ends with the winner on the winning score
+    template <int Width, int Height>
+    bool playsToTheEnd(Rng &rng)
+    {
+        BasicGameEngine<BasicBoard<Width, Height>> engine("First", "Second");
+        engine.reset();
+        engine.getPlayer(FIRST_SIDE).getOwnBoard().placeRandomShips(CLASSIC_PLAYER_FLEET, rng);
+        engine.getPlayer(SECOND_SIDE).getOwnBoard().placeRandomShips(CLASSIC_ENEMY_FLEET, rng);
+        int nextCell[2] = {0, 0};
+        while (!engine.isGameOver())
+        {
+            int side = engine.getCurrentSide();
+            if (nextCell[side] >= Width * Height)
+                return false;
+            int cell = nextCell[side]++;
+            engine.step(cell % Width, cell / Width);
+        }
+        return engine.getPlayer(engine.getWinner()).getScore() == engine.getWinningScore();
+    }
+
+    // True if kernel gives exactly the counts of the scalar reference on every snapshot
+    bool matchesReference(CountingKernel kernel, const std::vector<DecisionInput> &snapshots)
+    {
+        for (const auto &s : snapshots)
+        {
+            HeatmapCounts expected, actual;
+            countSnapshot(KERNEL_SCALAR, s.tracking, expected);
+            countSnapshot(kernel, s.tracking, actual);
+            if (std::memcmp(&expected, &actual, sizeof(expected)) != 0)
+                return false;
+        }
+        return true;
+    }
+
+    // Times a full recount of all placements with one kernel
+    BenchResult measureKernel(CountingKernel kernel, const std::vector<DecisionInput> &snapshots)
+    {
+        return measure(std::string("Placement counts: ") + countingKernelName(kernel), snapshots.size(), [&]()
+                       {
+            HeatmapCounts counts;
+            long long total = 0;
+            for (const auto &s : snapshots)
+            {
+                countSnapshot(kernel, s.tracking, counts);
+                total += counts.cover[27] + counts.hitCover[36];
+            }
+            sink = total; });
+    }
+
+    // Arrangement queries of the first side after each shot from the given one on, from smart self-play
+    std::vector<ArrangementQuery> captureQueries(int games, int fromShot, Rng &rng)
+    {
+        std::vector<ArrangementQuery> queries;
+        GameEngine engine("First", "Second");
+        HuntTargeting ai;
+        for (int g = 0; g < games; g++)
+        {
+            engine.reset();
+            ai.reset();
+            engine.getPlayer(FIRST_SIDE).getOwnBoard().placeRandomShips(false, rng);
+            engine.getPlayer(SECOND_SIDE).getOwnBoard().placeRandomShips(true, rng);
+            ArrangementQuery query = freshArrangementQuery(CLASSIC_ENEMY_FLEET);
+            for (int shot = 1; !engine.isGameOver(); shot++)
+            {
+                const Board &tracking = engine.getPlayer(FIRST_SIDE).getTrackingBoard();
+                Position target = ai.chooseTarget(tracking, rng);
+                ShotResult result = engine.fire(FIRST_SIDE, target.x, target.y);
+                ai.recordResult(tracking, target, result);
+                query.hits = tracking.getHitCells();
+                query.misses = tracking.getMissCells();
+                if (result.outcome == SHOT_SUNK)
+                {
+                    ShipKnowledge &known = query.ships[shipIndexOf(result.shipType)];
+                    known.sunk = true;
+                    known.sunkCell = cellIndex(target.x, target.y);
+                    known.hitsAtSink = query.hits;
+                }
+                if (shot >= fromShot && !engine.isGameOver())
+                    queries.push_back(query);
+            }
+        }
+        return queries;
+    }
+
+    // Times exact arrangement counts on one thread
+    BenchResult measureArrangements(const std::string &name, const std::vector<ArrangementQuery> &queries)
+    {
+        return measure(name, queries.size(), [&]()
+                       {
+            ArrangementCounts counts;
+            unsigned long long total = 0;
+            for (const auto &q : queries)
+            {
+                countArrangements(q, 1, counts);
+                total += counts.total;
+            }
+            sink = static_cast<long long>(total); });
+    }
+
+    // Times Monte Carlo estimates of draws arrangements each, on one thread with no time limit
+    BenchResult measureSampling(const std::string &name, unsigned int draws, const std::vector<ArrangementQuery> &queries)
+    {
+        SamplingLimits limits = {draws, 0, 1};
+        std::uint64_t seed = 0;
+        return measure(name, queries.size(), [&]()
+                       {
+            ArrangementCounts counts;
+            unsigned long long total = 0;
+            for (const auto &q : queries)
+            {
+                sampleArrangements(q, seed++, limits, counts);
+                total += counts.total;
+            }
+            sink = static_cast<long long>(total); });
+    }
+
+    void printTable(const std::vector<BenchResult> &results)
+    {
+        std::cout << std::left << std::setw(44) << "benchmark" << std::right << std::setw(14) << "ns/op"
+                  << std::setw(14) << "allocs/op" << std::setw(16) << "ops" << "\n";
+        for (const auto &r : results)
+        {
+            std::cout << std::left << std::setw(44) << r.name << std::right << std::fixed
+                      << std::setw(14) << std::setprecision(2) << r.nsPerOp
+                      << std::setw(14) << std::setprecision(3) << r.allocsPerOp
+                      << std::setw(16) << r.ops << "\n";
+        }
+    }
+
+    void printJson(const std::vector<BenchResult> &results)
+    {
+        std::cout << "{\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const BenchResult &r = results[i];
+            std::cout << "    {\"name\": \"" << r.name << "\", \"ops\": " << r.ops << std::fixed
+                      << ", \"ns_per_op\": " << std::setprecision(3) << r.nsPerOp
+                      << ", \"allocs_per_op\": " << std::setprecision(4) << r.allocsPerOp << "}"
+                      << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        std::cout << "  ]\n}\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    bool json = argc > 1 && std::strcmp(argv[1], "--json") == 0;
+    Rng rng(12345);
+    std::vector<BenchResult> results;
+
+    Rng smokeRng(1);
+    if (!playsToTheEnd<10, 10>(smokeRng) || !playsToTheEnd<32, 32>(smokeRng))
+    {
+        std::cerr << "bench: a game on a 10x10 or 32x32 board did not play to the end\n";
+        return 1;
+    }
+
+    Board fleet;
+    fleet.placeRandomShips(true, rng);
+
+    results.push_back(measure("Board::isValidPlacement", 4 * BOARD_SIZE * BOARD_SIZE, [&]()
+                              {
+        long long valid = 0;
+        for (int y = 0; y < BOARD_SIZE; y++)
+            for (int x = 0; x < BOARD_SIZE; x++)
+                for (int dir = 0; dir < 4; dir++)
+                    valid += fleet.isValidPlacement(x, y, 3, static_cast<Direction>(dir));
+        sink = valid; }));
+
+    results.push_back(measure("Board::placeShip (5 ships + clearBoard)", FLEET_SIZE, [&]()
+                              {
+        Board board;
+        for (int i = 0; i < FLEET_SIZE; i++)
+        {
+            Ship ship(PLAYER_FLEET[i].type, PLAYER_FLEET[i].length);
+            board.placeShip(ship, 0, i, RIGHT);
+        }
+        sink = static_cast<long long>(board.getShipCells()); }));
+
+    results.push_back(measure("Board::placeRandomShips", 1, [&]()
+                              {
+        Board board;
+        board.placeRandomShips(false, rng);
+        sink = static_cast<long long>(board.getShipCells()); }));
+
+    results.push_back(measure("Board::processShot (all 64 cells)", BOARD_SIZE * BOARD_SIZE, [&]()
+                              {
+        Board board = fleet;
+        long long hits = 0;
+        for (int y = 0; y < BOARD_SIZE; y++)
+            for (int x = 0; x < BOARD_SIZE; x++)
+                hits += board.processShot(x, y).outcome;
+        sink = hits; }));
+
+    results.push_back(measure("Board::allShipsDestroyed", 1, [&]()
+                              { sink = fleet.allShipsDestroyed(); }));
+
+    Player attacker("First");
+    Player defender("Second");
+    defender.getOwnBoard() = fleet;
+    results.push_back(measure("Player::attack (all 64 cells)", BOARD_SIZE * BOARD_SIZE, [&]()
+                              {
+        Player a = attacker;
+        Player d = defender;
+        long long hits = 0;
+        for (int y = 0; y < BOARD_SIZE; y++)
+            for (int x = 0; x < BOARD_SIZE; x++)
+                hits += a.attack(d, x, y).outcome;
+        sink = hits; }));
+
+    std::vector<DecisionInput> snapshots = captureSnapshots(20, rng);
+    results.push_back(measureDecision<RandomTargeting>("CPU decision: random", snapshots, rng));
+    results.push_back(measureDecision<HuntTargeting>("CPU decision: smart", snapshots, rng));
+    // Without its cache every expert decision is counted; with it, the warm-up call has stored
+    // every snapshot, so the second figure is the cost of a cache hit
+    results.push_back(measureDecision("CPU decision: expert", snapshots, rng, DensityTargeting(nullptr)));
+    results.push_back(measureDecision<DensityTargeting>("CPU decision: expert, cached lookup", snapshots, rng));
+    for (int kernel = 0; kernel < KERNEL_COUNT; kernel++)
+    {
+        if (!isKernelAvailable(static_cast<CountingKernel>(kernel)))
+            continue;
+        if (!matchesReference(static_cast<CountingKernel>(kernel), snapshots))
+        {
+            std::cerr << "bench: the " << countingKernelName(static_cast<CountingKernel>(kernel))
+                      << " counting kernel disagrees with the scalar reference\n";
+            return 1;
+        }
+        results.push_back(measureKernel(static_cast<CountingKernel>(kernel), snapshots));
+    }
+    std::vector<ArrangementQuery> midGame = captureQueries(5, 15, rng);
+    results.push_back(measureArrangements("Arrangement count: from shot 15", midGame));
+    results.push_back(measureArrangements("Arrangement count: from shot 30", captureQueries(5, 30, rng)));
+    results.push_back(measureSampling("Arrangement sampling: 10000 draws", 10000, midGame));
+    results.push_back(measureGame<HuntTargeting>("CPU game: smart vs smart", rng));
+    results.push_back(measureGame<DensityTargeting>("CPU game: expert vs expert", rng));
+
+    if (json)
+    {
+        printJson(results);
+    }
+    else
+    {
+        printTable(results);
+        std::cout << "Counting kernel in use: " << countingKernelName(bestCountingKernel()) << "\n";
+    }
+    return 0;
+}
\ No newline at end of file
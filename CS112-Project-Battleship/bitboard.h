@@ -0,0 +1,183 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+#include <type_traits>
+
+// Side length of the classic board; other sizes are template arguments of BasicBoard
+const int BOARD_SIZE = 8;
+
+// A set of board cells packed into one 64-bit word, one bit per cell (bit y * 8 + x)
+typedef std::uint64_t Bitboard;
+
+// Bit index of the cell (x, y) inside a Bitboard
+constexpr int cellIndex(int x, int y)
+{
+    return y * BOARD_SIZE + x;
+}
+
+// Returns a mask with only the given cell index set
+constexpr Bitboard cellBit(int index)
+{
+    return Bitboard(1) << index;
+}
+
+// Counts the number of cells set in a mask
+inline int popCount(Bitboard mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(mask);
+#else
+    int count = 0;
+    while (mask)
+    {
+        mask &= mask - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+// Returns the index of the lowest cell set in a non-empty mask
+inline int lowestCell(Bitboard mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(mask);
+#else
+    int index = 0;
+    while (!(mask & 1))
+    {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+// Cell set for boards with more than 64 cells: Words 64-bit words, cell i in bit i % 64 of word i / 64.
+// It supports the same operators as Bitboard, so board code is written once for both.
+// Bits past the last cell may be set by ~; they never match a real cell, so masks are
+// always combined with a cell mask before they are counted or iterated.
+template <int Words>
+class WideBitboard
+{
+private:
+    std::uint64_t words[Words];
+
+public:
+    constexpr WideBitboard() : words{} {}
+    constexpr WideBitboard(std::uint64_t low) : words{}
+    {
+        words[0] = low;
+    }
+
+    // Returns a mask with only the given cell index set
+    static constexpr WideBitboard bit(int index)
+    {
+        WideBitboard mask;
+        mask.words[index / 64] = std::uint64_t(1) << (index % 64);
+        return mask;
+    }
+
+    constexpr std::uint64_t word(int i) const { return words[i]; }
+
+    constexpr WideBitboard &operator|=(const WideBitboard &other)
+    {
+        for (int i = 0; i < Words; i++)
+            words[i] |= other.words[i];
+        return *this;
+    }
+    constexpr WideBitboard &operator&=(const WideBitboard &other)
+    {
+        for (int i = 0; i < Words; i++)
+            words[i] &= other.words[i];
+        return *this;
+    }
+    constexpr WideBitboard &operator^=(const WideBitboard &other)
+    {
+        for (int i = 0; i < Words; i++)
+            words[i] ^= other.words[i];
+        return *this;
+    }
+    constexpr WideBitboard operator~() const
+    {
+        WideBitboard result;
+        for (int i = 0; i < Words; i++)
+            result.words[i] = ~words[i];
+        return result;
+    }
+    friend constexpr WideBitboard operator|(WideBitboard a, const WideBitboard &b) { return a |= b; }
+    friend constexpr WideBitboard operator&(WideBitboard a, const WideBitboard &b) { return a &= b; }
+    friend constexpr WideBitboard operator^(WideBitboard a, const WideBitboard &b) { return a ^= b; }
+
+    constexpr bool operator==(const WideBitboard &other) const
+    {
+        for (int i = 0; i < Words; i++)
+            if (words[i] != other.words[i])
+                return false;
+        return true;
+    }
+    constexpr bool operator!=(const WideBitboard &other) const { return !(*this == other); }
+
+    // True if any cell is set, so masks test like Bitboard in conditions
+    constexpr explicit operator bool() const
+    {
+        for (int i = 0; i < Words; i++)
+            if (words[i])
+                return true;
+        return false;
+    }
+
+    int count() const
+    {
+        int total = 0;
+        for (int i = 0; i < Words; i++)
+            total += popCount(words[i]);
+        return total;
+    }
+
+    int lowest() const
+    {
+        for (int i = 0;; i++)
+            if (words[i])
+                return i * 64 + lowestCell(words[i]);
+    }
+
+    void clearLowest()
+    {
+        for (int i = 0; i < Words; i++)
+        {
+            if (words[i])
+            {
+                words[i] &= words[i] - 1;
+                return;
+            }
+        }
+    }
+};
+
+template <int Words>
+inline int popCount(const WideBitboard<Words> &mask) { return mask.count(); }
+template <int Words>
+inline int lowestCell(const WideBitboard<Words> &mask) { return mask.lowest(); }
+
+// Removes the lowest cell from a non-empty mask; the loop step of code written for any mask type
+inline void clearLowestCell(Bitboard &mask) { mask &= mask - 1; }
+template <int Words>
+inline void clearLowestCell(WideBitboard<Words> &mask) { mask.clearLowest(); }
+
+// The cell set type for a board of the given number of cells: a single Bitboard up to 64
+// cells, so the classic board keeps its one-word layout, and a WideBitboard above that
+template <int Cells>
+struct CellMask
+{
+    typedef typename std::conditional<(Cells <= 64), Bitboard, WideBitboard<(Cells + 63) / 64>>::type type;
+};
+
+// Returns a mask of type Mask with only the given cell index set
+template <class Mask>
+constexpr Mask singleCell(int index) { return Mask::bit(index); }
+template <>
+constexpr Bitboard singleCell<Bitboard>(int index) { return cellBit(index); }
+
+#endif
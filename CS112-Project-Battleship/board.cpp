@@ -1,7 +1,8 @@
 #include "board.h"
 #include "player.h"
+#include "render.h"
+#include <cctype>
 #include <cstdlib>
-#include <ctime>
 #include <string>
 #include <iostream>
 #include <vector>
@@ -28,301 +29,105 @@ bool Position::operator==(const Position &other) const
     return x == other.x && y == other.y;
 }
 
-// Ship implementations
-// Represents a ship in the game.
-// Constructs a Ship object with a given type and length.
-Ship::Ship(char shipType, int shipLength) : type(shipType), length(shipLength), hitsRemaining(shipLength) {}
-
-// Gets the type of the ship.
-char Ship::getType() const { return type; }
-// Gets the length of the ship.
-int Ship::getLength() const { return length; }
-// Gets the remaining hits the ship can take.
-int Ship::getHitsRemaining() const { return hitsRemaining; }
-
-// Checks if the ship is destroyed.
-bool Ship::isDestroyed() const { return hitsRemaining <= 0; }
-
-// Records a hit on the ship, decrementing hitsRemaining.
-void Ship::hit()
+// Length of a ship type from either fleet, 0 if the type is unknown
+int shipLengthOf(char shipType)
 {
-    if (hitsRemaining > 0)
+    for (int i = 0; i < FLEET_SIZE; i++)
     {
-        hitsRemaining--;
-    }
-}
-
-// Adds a position to the ship's list of occupied positions.
-void Ship::addPosition(const Position &pos)
-{
-    positions.push_back(pos);
-}
-
-// Gets the list of positions occupied by the ship.
-const std::vector<Position> &Ship::getPositions() const
-{
-    return positions;
-}
-
-// Board implementations
-// Represents the game board.
-// Constructs a Board object and initializes it.
-Board::Board()
-{
-    clearBoard();
-}
-
-// Clears the board, setting all cells to EMPTY_CHAR and removing all ships.
-void Board::clearBoard()
-{
-    for (int y = 0; y < BOARD_SIZE; y++)
-    {
-        for (int x = 0; x < BOARD_SIZE; x++)
-        {
-            grid[y][x] = EMPTY_CHAR;
-        }
+        if (PLAYER_FLEET[i].type == shipType)
+            return PLAYER_FLEET[i].length;
+        if (ENEMY_FLEET[i].type == shipType)
+            return ENEMY_FLEET[i].length;
     }
-    ships.clear();
+    return 0;
 }
 
-// Gets the character at a specific cell on the board.
-char Board::getCell(int x, int y) const
+// Position of a ship type in its fleet, -1 if the type is unknown
+int shipIndexOf(char shipType)
 {
-    if (x >= 0 && x < BOARD_SIZE && y >= 0 && y < BOARD_SIZE)
+    for (int i = 0; i < FLEET_SIZE; i++)
     {
-        return grid[y][x];
+        if (PLAYER_FLEET[i].type == shipType || ENEMY_FLEET[i].type == shipType)
+            return i;
     }
-    return ' ';
+    return -1;
 }
 
-// Sets the character at a specific cell on the board.
-void Board::setCell(int x, int y, char value)
-{
-    if (x >= 0 && x < BOARD_SIZE && y >= 0 && y < BOARD_SIZE)
-    {
-        grid[y][x] = value;
-    }
-}
+// The classic board and ship are compiled here once; other sizes are instantiated where they are used
+template class BasicShip<BOARD_SIZE, BOARD_SIZE>;
+template class BasicBoard<BOARD_SIZE, BOARD_SIZE>;
+// A multi-word size is compiled in full too, so every member keeps building beyond one Bitboard
+template class BasicShip<10, 10>;
+template class BasicBoard<10, 10>;
+template class BasicShip<32, 32>;
+template class BasicBoard<32, 32>;
 
-// Checks if a specific cell on the board is empty.
-bool Board::isEmptyCell(int x, int y) const
-{
-    return getCell(x, y) == EMPTY_CHAR;
-}
+// Last row letter accepted from the keyboard; columns run from 1 to Board::WIDTH
+static const char LAST_ROW = static_cast<char>('A' + Board::HEIGHT - 1);
 
-// Checks if a ship placement is valid.
-bool Board::isValidPlacement(int x, int y, int length, Direction dir) const
+// Coordinate parsing
+// A row letter followed by 1-2 digits; anything else is rejected without exceptions.
+CoordinateStatus parseCoordinate(const std::string &text, Position &pos)
 {
-    switch (dir)
+    if (text.length() < 2 || text.length() > 3 || !isalpha(static_cast<unsigned char>(text[0])))
     {
-    case LEFT:
-        if (x - length + 1 < 0)
-            return false;
-        for (int i = 0; i < length; i++)
-        {
-            if (!isEmptyCell(x - i, y))
-                return false;
-        }
-        break;
-    case RIGHT:
-        if (x + length > BOARD_SIZE)
-            return false;
-        for (int i = 0; i < length; i++)
-        {
-            if (!isEmptyCell(x + i, y))
-                return false;
-        }
-        break;
-    case UP:
-        if (y - length + 1 < 0)
-            return false;
-        for (int i = 0; i < length; i++)
-        {
-            if (!isEmptyCell(x, y - i))
-                return false;
-        }
-        break;
-    case DOWN:
-        if (y + length > BOARD_SIZE)
-            return false;
-        for (int i = 0; i < length; i++)
-        {
-            if (!isEmptyCell(x, y + i))
-                return false;
-        }
-        break;
+        return COORD_BAD_FORMAT;
     }
-    return true;
-}
-
-// Places a ship on the board.
-void Board::placeShip(Ship &ship, int x, int y, Direction dir)
-{
-    int length = ship.getLength();
-
-    switch (dir)
+    int column = 0;
+    for (size_t i = 1; i < text.length(); i++)
     {
-    case LEFT:
-        for (int i = 0; i < length; i++)
-        {
-            grid[y][x - i] = ship.getType();
-            ship.addPosition(Position(x - i, y));
-        }
-        break;
-    case RIGHT:
-        for (int i = 0; i < length; i++)
-        {
-            grid[y][x + i] = ship.getType();
-            ship.addPosition(Position(x + i, y));
-        }
-        break;
-    case UP:
-        for (int i = 0; i < length; i++)
-        {
-            grid[y - i][x] = ship.getType();
-            ship.addPosition(Position(x, y - i));
-        }
-        break;
-    case DOWN:
-        for (int i = 0; i < length; i++)
-        {
-            grid[y + i][x] = ship.getType();
-            ship.addPosition(Position(x, y + i));
-        }
-        break;
+        if (!isdigit(static_cast<unsigned char>(text[i])))
+            return COORD_BAD_FORMAT;
+        column = column * 10 + (text[i] - '0');
     }
 
-    ships.push_back(ship);
-}
-
-// Places ships randomly on the board.
-// isEnemyBoard: True if placing ships for the enemy, false for the player.
-// This determines the set of ships to be placed.
-void Board::placeRandomShips(bool isEnemyBoard)
-{
-    // Seed random number generator,
-    srand(static_cast<unsigned int>(time(nullptr)) + (isEnemyBoard ? 100 : 0));
-
-    struct ShipDef
+    char row = static_cast<char>(toupper(static_cast<unsigned char>(text[0])));
+    if (row > LAST_ROW)
     {
-        char type;
-        int length;
-    };
-
-    std::vector<ShipDef> shipsToPlace;
-
-    if (isEnemyBoard)
-    {
-        shipsToPlace = {
-            {'A', 5}, // Alpha
-            {'B', 4}, // Bravo
-            {'C', 3}, // Charlie
-            {'D', 3}, // Delta
-            {'E', 2}  // Echo
-        };
+        return COORD_BAD_ROW;
     }
-    else
+    if (column < 1 || column > Board::WIDTH)
     {
-        shipsToPlace = {
-            {'T', 5}, // PNS Tughril
-            {'Z', 4}, // PNS Zulfiqar
-            {'H', 3}, // PNS Hangor
-            {'Y', 3}, // PNS Yarmuk
-            {'M', 2}  // PNS Mujahid
-        };
-    }
-
-    for (const auto &def : shipsToPlace)
-    {
-        bool placed = false;
-        while (!placed)
-        {
-            int x = rand() % BOARD_SIZE;
-            int y = rand() % BOARD_SIZE;
-            Direction dir = static_cast<Direction>(rand() % 4);
-
-            if (isValidPlacement(x, y, def.length, dir))
-            {
-                Ship ship(def.type, def.length);
-                placeShip(ship, x, y, dir);
-                placed = true;
-            }
-        }
+        return COORD_BAD_COLUMN;
     }
+    pos = Position(column - 1, row - 'A');
+    return COORD_OK;
 }
 
-// Processes a shot at a given coordinate.
-// Returns true if the shot was a hit on a ship and valid,
-// false otherwise (miss, already shot, or out of bounds).
-bool Board::processShot(int x, int y)
+// Accepts the direction names used in scripts and their first letters
+bool parseDirection(const std::string &text, Direction &dir)
 {
-    if (x < 0 || x >= BOARD_SIZE || y < 0 || y >= BOARD_SIZE)
-    {
-        return false;
-    }
-
-    char cell = grid[y][x];
+    string word;
+    for (char c : text)
+        word += static_cast<char>(tolower(static_cast<unsigned char>(c)));
 
-    // Already shot here
-    if (cell == MISS_CHAR || cell == HIT_CHAR)
-    {
-        return false;
-    }
-
-    // miss
-    if (cell == EMPTY_CHAR)
-    {
-        grid[y][x] = MISS_CHAR;
+    if (word == "l" || word == "left")
+        dir = LEFT;
+    else if (word == "r" || word == "right")
+        dir = RIGHT;
+    else if (word == "u" || word == "up")
+        dir = UP;
+    else if (word == "d" || word == "down")
+        dir = DOWN;
+    else
         return false;
-    }
-
-    // hit
-    char shipType = cell;
-    grid[y][x] = HIT_CHAR;
-
-    // find and update the ship
-    for (auto &ship : ships)
-    {
-        if (ship.getType() == shipType)
-        {
-            ship.hit();
-            break;
-        }
-    }
-
     return true;
 }
 
-// Checks if all ships on the board have been destroyed.
-bool Board::allShipsDestroyed() const
-{
-    for (const auto &ship : ships)
-    {
-        if (!ship.isDestroyed())
-        {
-            return false;
-        }
-    }
-    return !ships.empty();
-}
+// Frame buffer behind drawGameBoard; anything that clears the screen must invalidate it
+static FrameRenderer boardFrame;
+
+// Turbo mode: every delay and animation becomes a no-op while the printed text stays the same.
+bool UI::turbo = false;
 
-// Checks if a specific ship type has been destroyed.
-bool Board::isShipDestroyed(char shipType) const
+void UI::setTurbo(bool enabled)
 {
-    for (const auto &ship : ships)
-    {
-        if (ship.getType() == shipType && ship.isDestroyed())
-        {
-            return true;
-        }
-    }
-    return false;
+    turbo = enabled;
 }
 
-// Gets the list of ships on the board.
-const std::vector<Ship> &Board::getShips() const
+bool UI::isTurbo()
 {
-    return ships;
+    return turbo;
 }
 
 // Clears the console screen.
@@ -330,11 +135,16 @@ const std::vector<Ship> &Board::getShips() const
 void UI::clearScreen()
 {
     cout << "\033[2J\033[1;1H";
+    boardFrame.invalidate();
 }
 
 // Pauses execution for a specified duration.
 void UI::delay(int milliseconds)
 {
+    if (turbo)
+    {
+        return;
+    }
     this_thread::sleep_for(chrono::milliseconds(milliseconds));
 }
 
@@ -387,7 +197,7 @@ void UI::loadingEffect(const string &message, int dotCount, int delayMs)
     {
         cout << ".";
         cout.flush();
-        this_thread::sleep_for(chrono::milliseconds(delayMs));
+        delay(delayMs);
     }
     cout << endl;
 }
@@ -396,7 +206,7 @@ void UI::loadingEffect(const string &message, int dotCount, int delayMs)
 void UI::spinner(int durationMs)
 {
     const char spinnerChars[] = {'|', '/', '-', '\\'};
-    int steps = durationMs / 100;
+    int steps = turbo ? 0 : durationMs / 100; // turbo skips straight to the final frame
     string prefix = "Loading ";
 
     cout << prefix << spinnerChars[0] << flush;
@@ -409,38 +219,51 @@ void UI::spinner(int durationMs)
 }
 
 // Draws the main game board, showing the player's own board and their tracking board for the opponent.
+// The frame is composed off-screen and only the cells that changed since the last draw are sent to the terminal.
 void UI::drawGameBoard(const Player &player, const Player &opponent)
 {
-    cout << "\n\n\n";
-    cout << "\n\n\n";
-    cout << "\t\t1    2    3    4    5    6    7    8\t\t\t\t         1    2    3    4    5    6    7    8" << endl;
-    cout << "\t    _____________________________________________ \t\t\t    _____________________________________________     " << endl;
-    cout << "\t   | ___________________________________________ |\t\t\t   | ___________________________________________ |    " << endl;
-    cout << "\t   ||                                           ||\t\t\t   ||                                           ||    " << endl;
+    boardFrame.beginFrame();
+    boardFrame.print("\n\n\n");
+    boardFrame.print("\n\n\n");
+    boardFrame.print("\t\t1    2    3    4    5    6    7    8\t\t\t\t         1    2    3    4    5    6    7    8\n");
+    boardFrame.print("\t    _____________________________________________ \t\t\t    _____________________________________________     \n");
+    boardFrame.print("\t   | ___________________________________________ |\t\t\t   | ___________________________________________ |    \n");
+    boardFrame.print("\t   ||                                           ||\t\t\t   ||                                           ||    \n");
 
-    for (int i = 0; i < BOARD_SIZE; i++)
+    for (int i = 0; i < Board::HEIGHT; i++)
     {
         char rowLabel = 'A' + i;
-        cout << "\t " << rowLabel << " ||   ";
-        for (int j = 0; j < BOARD_SIZE; j++)
+        boardFrame.print("\t ");
+        boardFrame.print(rowLabel);
+        boardFrame.print(" ||   ");
+        for (int j = 0; j < Board::WIDTH; j++)
         {
-            cout << player.getOwnBoard().getCell(j, i) << "    ";
+            boardFrame.print(player.getOwnBoard().getCell(j, i));
+            boardFrame.print("    ");
         }
-        cout << "||\t\t\t " << rowLabel << " ||   ";
-        for (int j = 0; j < BOARD_SIZE; j++)
+        boardFrame.print("||\t\t\t ");
+        boardFrame.print(rowLabel);
+        boardFrame.print(" ||   ");
+        for (int j = 0; j < Board::WIDTH; j++)
         {
-            cout << player.getTrackingBoard().getCell(j, i) << "    ";
+            boardFrame.print(player.getTrackingBoard().getCell(j, i));
+            boardFrame.print("    ");
         }
-        cout << "||" << endl;
-        cout << "\t   ||\t\t\t\t\t\t||\t\t\t   ||\t\t\t\t\t\t||" << endl;
+        boardFrame.print("||\n");
+        boardFrame.print("\t   ||\t\t\t\t\t\t||\t\t\t   ||\t\t\t\t\t\t||\n");
     }
 
-    cout << "\t   ||___________________________________________||\t\t\t   ||___________________________________________||         " << endl;
-    cout << "\t   |_____________________________________________|\t\t\t   |_____________________________________________|       " << endl;
-    cout << "\n\t\t\tYour Ships\t\t\t\t\t\t\t\t\tEnemy Waters\n";
-    cout << "\n";
-    cout << "\t\t\t(Player: T=Tughril(5), Z=Zulfiqar(4), H=Hangor(3), Y=Yarmuk(3), M=Mujahid(2))\n";                                                     // Clarified Player ships
-    cout << "\t\t\t(Enemy:  A=Alpha(5),   B=Bravo(4),   C=Charlie(3), D=Delta(3),   E=Echo(2))\t\t(" << HIT_CHAR << "=Hit, " << MISS_CHAR << "=Miss)\n"; // Clarified Enemy ships
+    boardFrame.print("\t   ||___________________________________________||\t\t\t   ||___________________________________________||         \n");
+    boardFrame.print("\t   |_____________________________________________|\t\t\t   |_____________________________________________|       \n");
+    boardFrame.print("\n\t\t\tYour Ships\t\t\t\t\t\t\t\t\tEnemy Waters\n");
+    boardFrame.print("\n");
+    boardFrame.print("\t\t\t(Player: T=Tughril(5), Z=Zulfiqar(4), H=Hangor(3), Y=Yarmuk(3), M=Mujahid(2))\n"); // Clarified Player ships
+    boardFrame.print("\t\t\t(Enemy:  A=Alpha(5),   B=Bravo(4),   C=Charlie(3), D=Delta(3),   E=Echo(2))\t\t(");         // Clarified Enemy ships
+    boardFrame.print(HIT_CHAR);
+    boardFrame.print("=Hit, ");
+    boardFrame.print(MISS_CHAR);
+    boardFrame.print("=Miss)\n");
+    boardFrame.present();
 }
 
 // Displays the game rules.
@@ -467,7 +290,7 @@ void UI::displayGameRules()
 }
 
 // Displays the main menu of the game.
-void UI::displayMainMenu(bool cpuSmartMode)
+void UI::displayMainMenu(const std::string &cpuIntelligence)
 {
     clearScreen();
     Battleshiplogo();
@@ -475,7 +298,7 @@ void UI::displayMainMenu(bool cpuSmartMode)
     cout << "\n\n";
     UI::loadingEffect("Sink or be sunk", 3, 500);
     UI::spinner(3000);
-    this_thread::sleep_for(chrono::milliseconds(1000));
+    delay(1000);
     cout << "\n\n";
     cout << R"(   ______________________________
  / \        ~~ MAIN MENU ~~      \.
@@ -484,7 +307,7 @@ void UI::displayMainMenu(bool cpuSmartMode)
 |   |    3. Exit                 |.
 |   |    4. Quickplay Demo       |.
 |   |    5. Toggle CPU Intelligence (Current: )"
-         << (cpuSmartMode ? "Smart" : "Normal") << R"()                 |.
+         << cpuIntelligence << R"()                 |.
  \_ |                            |.
     |                            |.
     |                            |.
@@ -533,7 +356,7 @@ void UI::displayGameOver(const Player &player, const Player &cpu)
 
     cout << "\n\n\n\t\t\t\t\t\t";
 
-    if (cpu.getScore() == 17)
+    if (player.getOwnBoard().allShipsDestroyed())
     {
         cout << R"(
 
@@ -555,6 +378,26 @@ void UI::displayGameOver(const Player &player, const Player &cpu)
     cin.get();
 }
 
+// Prints why a typed coordinate was rejected; returns true if it was accepted
+static bool reportCoordinate(CoordinateStatus status, const char *what)
+{
+    switch (status)
+    {
+    case COORD_OK:
+        return true;
+    case COORD_BAD_ROW:
+        cout << "\tInvalid row. Use letters A-" << LAST_ROW << ".\n";
+        break;
+    case COORD_BAD_COLUMN:
+        cout << "\tInvalid column. Use numbers 1-" << Board::WIDTH << ".\n";
+        break;
+    default:
+        cout << "\tInvalid " << what << " format. Try again.\n";
+        break;
+    }
+    return false;
+}
+
 // Gets the target coordinates from the player for their shot.
 // Allows the player to enter 'B' to go back.
 // Returns a Position object representing the target, or Position(-2, -2) if the player chose to go back.
@@ -564,45 +407,20 @@ Position UI::getPlayerTarget()
     while (true)
     {
         cout << "\n\tEnter target coordinate (e.g. A5) or 'B' to go back: ";
-        cin >> input;
-
-        if (toupper(input[0]) == 'B' && input.length() == 1)
+        if (!(cin >> input))
         {
-            return Position(-2, -2);
+            return Position(-2, -2); // no more input: treat it as going back
         }
 
-        if (input.length() < 2)
+        if (toupper(input[0]) == 'B' && input.length() == 1)
         {
-            cout << "\tInvalid coordinate format. Try again.\n";
-            continue;
+            return Position(-2, -2);
         }
 
-        char rowInput = toupper(input[0]);
-        if (rowInput < 'A' || rowInput > 'H')
+        Position target;
+        if (reportCoordinate(parseCoordinate(input, target), "coordinate"))
         {
-            cout << "\tInvalid row. Use letters A-H.\n";
-            continue;
-        }
-
-        try
-        {
-            int colInput = stoi(input.substr(1));
-            if (colInput < 1 || colInput > 8)
-            {
-                cout << "\tInvalid column. Use numbers 1-8.\n";
-                continue;
-            }
-
-            int rowIndex = rowInput - 'A';
-
-            int colIndex = colInput - 1;
-
-            return Position(colIndex, rowIndex);
-        }
-        catch (...)
-        {
-            cout << "\tInvalid column number. Try again.\n";
-            continue;
+            return target;
         }
     }
 }
@@ -649,46 +467,20 @@ Position UI::getShipStartPosition()
     while (true)
     {
         cout << "\tEnter starting position (e.g. A5) or 'B' to go back: ";
-        cin >> input;
-
-        if (toupper(input[0]) == 'B' && input.length() == 1)
+        if (!(cin >> input))
         {
-            return Position(-2, -2); // Special value for back
-        }
-
-        if (input.length() < 2)
-        {
-            cout << "\tInvalid position format. Try again.\n";
-            continue;
+            return Position(-2, -2);
         }
 
-        char rowInput = toupper(input[0]);
-        if (rowInput < 'A' || rowInput > 'H')
+        if (toupper(input[0]) == 'B' && input.length() == 1)
         {
-            cout << "\tInvalid row. Use letters A-H.\n";
-            continue;
+            return Position(-2, -2); // Special value for back
         }
 
-        try
+        Position start;
+        if (reportCoordinate(parseCoordinate(input, start), "position"))
         {
-            int colInput = stoi(input.substr(1));
-            if (colInput < 1 || colInput > 8)
-            {
-                cout << "\tInvalid column. Use numbers 1-8.\n";
-                continue;
-            }
-
-            // Convert row character to index (A=0, B=1, etc.)
-            int rowIndex = rowInput - 'A';
-            // Adjust column index (user inputs 1-8, we use 0-7)
-            int colIndex = colInput - 1;
-
-            return Position(colIndex, rowIndex);
-        }
-        catch (...)
-        {
-            cout << "\tInvalid column number. Try again.\n";
-            continue;
+            return start;
         }
     }
 }
@@ -711,6 +503,10 @@ Direction UI::getShipDirection()
 
         if (!(cin >> dirInput))
         {
+            if (cin.eof())
+            {
+                return static_cast<Direction>(-2); // input ended: same as Back
+            }
             cout << "\tInvalid input. Please enter a number.\n";
             clearInputBuffer();
             continue;
@@ -739,12 +535,12 @@ void UI::displayPlayerBoard(const Board &board)
     cout << "\t\t  1  2  3  4  5  6  7  8\n";
     cout << "\t\t  -----------------------\n";
 
-    for (int i = 0; i < BOARD_SIZE; i++)
+    for (int i = 0; i < Board::HEIGHT; i++)
     {
         char rowLabel = 'A' + i;
         cout << "\t\t" << rowLabel << "|";
 
-        for (int j = 0; j < BOARD_SIZE; j++)
+        for (int j = 0; j < Board::WIDTH; j++)
         {
             cout << " " << board.getCell(j, i) << " ";
         }
@@ -6,11 +6,12 @@
 #include <thread>
 #include <limits>
 #include <vector>
+#include "bitboard.h"
+#include "placements.h"
+#include "rng.h"
+#include "fixed_vector.h"
 
-class Player;
-
-// Constants
-const int BOARD_SIZE = 8;
+// Constants (BOARD_SIZE comes from bitboard.h)
 const char EMPTY_CHAR = 249;
 const char MISS_CHAR = 176;  // For missed shots
 const char HIT_CHAR = 254;   // For hit ships
@@ -25,6 +26,71 @@ enum Direction
     DOWN = 3
 };
 
+// ship types and lengths of the two fleets
+struct ShipDef
+{
+    char type;
+    int length;
+};
+
+// A fleet to deploy on a board: its ship definitions and how many there are
+struct Fleet
+{
+    const ShipDef *ships;
+    int size;
+
+    // Number of hits needed to sink the whole fleet
+    constexpr int cells() const
+    {
+        int total = 0;
+        for (int i = 0; i < size; i++)
+            total += ships[i].length;
+        return total;
+    }
+};
+
+const int FLEET_SIZE = 5;
+constexpr ShipDef PLAYER_FLEET[FLEET_SIZE] = {
+    {'T', 5}, // PNS Tughril
+    {'Z', 4}, // PNS Zulfiqar
+    {'H', 3}, // PNS Hangor
+    {'Y', 3}, // PNS Yarmuk
+    {'M', 2}  // PNS Mujahid
+};
+constexpr ShipDef ENEMY_FLEET[FLEET_SIZE] = {
+    {'A', 5}, // Alpha
+    {'B', 4}, // Bravo
+    {'C', 3}, // Charlie
+    {'D', 3}, // Delta
+    {'E', 2}  // Echo
+};
+constexpr Fleet CLASSIC_PLAYER_FLEET = {PLAYER_FLEET, FLEET_SIZE};
+constexpr Fleet CLASSIC_ENEMY_FLEET = {ENEMY_FLEET, FLEET_SIZE};
+const int CLASSIC_WINNING_SCORE = CLASSIC_PLAYER_FLEET.cells(); // 17
+
+// Length of a ship type from either fleet, 0 if the type is unknown
+int shipLengthOf(char shipType);
+// Position of a ship type in its fleet, -1 if the type is unknown
+int shipIndexOf(char shipType);
+
+// outcome of a single shot
+enum ShotOutcome
+{
+    SHOT_MISS,
+    SHOT_HIT,
+    SHOT_SUNK,
+    SHOT_ALREADY_TAKEN,
+    SHOT_INVALID
+};
+
+// structured result of a shot
+struct ShotResult
+{
+    ShotOutcome outcome;
+    char shipType; // type of the ship hit or sunk, 0 otherwise
+    bool gameOver; // true if this shot destroyed the last ship of the fleet
+};
+
 // position class to represent coordinates
 class Position
 {
@@ -39,60 +105,131 @@ public:
     bool operator==(const Position &other) const;
 };
 
-class Ship
+// A ship on a Width x Height board
+template <int Width, int Height, int MaxLength = MAX_SHIP_LENGTH>
+class BasicShip
 {
+public:
+    typedef typename CellMask<Width * Height>::type Mask;
+
 private:
     char type;
     int length;
     int hitsRemaining;
-    std::vector<Position> positions;
+    FixedVector<Position, MaxLength> positions; // stored inline, no heap allocation
+    Mask mask;                                  // cells covered by the ship
 
 public:
-    Ship(char shipType, int shipLength);
+    BasicShip();
+    BasicShip(char shipType, int shipLength);
 
-    char getType() const;
-    int getLength() const;
-    int getHitsRemaining() const;
+    char getType() const { return type; }
+    int getLength() const { return length; }
+    int getHitsRemaining() const { return hitsRemaining; }
 
-    bool isDestroyed() const;
+    bool isDestroyed() const { return hitsRemaining <= 0; }
     void hit();
     void addPosition(const Position &pos);
-    const std::vector<Position> &getPositions() const;
+    const FixedVector<Position, MaxLength> &getPositions() const { return positions; }
+    const Mask &getMask() const { return mask; }
 };
 
-class Board
+// A Width x Height board holding at most MaxShips ships of length up to MaxShipLength.
+// Cell sets are CellMask<Width * Height>::type: one Bitboard word for boards of up to 64 cells
+// and a multi-word WideBitboard above that, so the classic board keeps its single-word layout.
+// Member functions are defined below; the classic Board is compiled once in board.cpp.
+template <int Width, int Height, int MaxShips = FLEET_SIZE, int MaxShipLength = MAX_SHIP_LENGTH>
+class BasicBoard
 {
+public:
+    static constexpr int WIDTH = Width;
+    static constexpr int HEIGHT = Height;
+    static constexpr int CELLS = Width * Height;
+    typedef typename CellMask<CELLS>::type Mask;
+    typedef BasicShip<Width, Height, MaxShipLength> ShipType;
+    typedef PlacementTable<Width, Height, MaxShipLength> Placements;
+
+    static_assert(MaxShips < 128, "ship indices are stored in a signed char");
+
 private:
-    char grid[BOARD_SIZE][BOARD_SIZE];
-    std::vector<Ship> ships;
+    // Board state as cell masks; the character grid is derived from these by getCell
+    Mask shipCells; // cells occupied by any ship
+    Mask hitCells;  // shots that struck a ship
+    Mask missCells; // shots that fell in open water
+    FixedVector<ShipType, MaxShips> ships; // stored inline so boards copy and reset without allocating
+    signed char shipAt[CELLS];             // index into ships for every cell, -1 for water
+    std::uint64_t stateHash;               // Zobrist hash of the hit and miss markers
+
+    static int findPlacement(int x, int y, int length, Direction dir);
 
 public:
-    Board();
+    BasicBoard();
+
+    // True if (x, y) lies on the board
+    static bool contains(int x, int y) { return x >= 0 && x < Width && y >= 0 && y < Height; }
 
     void clearBoard();
     char getCell(int x, int y) const;
     void setCell(int x, int y, char value);
     bool isEmptyCell(int x, int y) const;
     bool isValidPlacement(int x, int y, int length, Direction dir) const;
-    void placeShip(Ship &ship, int x, int y, Direction dir);
-    void placeRandomShips(bool isEnemyBoard);
-    bool processShot(int x, int y);
+    void placeShip(ShipType &ship, int x, int y, Direction dir);
+    void placeRandomShips(const Fleet &fleet, Rng &rng);
+    void placeRandomShips(bool isEnemyBoard, Rng &rng); // the classic player or enemy fleet
+    ShotResult processShot(int x, int y);
     bool allShipsDestroyed() const;
     bool isShipDestroyed(char shipType) const;
-    const std::vector<Ship> &getShips() const;
+    const FixedVector<ShipType, MaxShips> &getShips() const { return ships; }
+
+    const Mask &getShipCells() const { return shipCells; }
+    const Mask &getHitCells() const { return hitCells; }
+    const Mask &getMissCells() const { return missCells; }
+
+    // Zobrist hash of the shots on the board, kept up to date by setCell and processShot.
+    // Ships are not part of it, so two tracking boards with the same hits and misses hash alike.
+    std::uint64_t getStateHash() const { return stateHash; }
 };
 
+// The classic 8x8 game
+typedef BasicBoard<BOARD_SIZE, BOARD_SIZE> Board;
+typedef Board::ShipType Ship;
+extern template class BasicShip<BOARD_SIZE, BOARD_SIZE>;
+extern template class BasicBoard<BOARD_SIZE, BOARD_SIZE>;
+
+template <class BoardType>
+class BasicPlayer;
+typedef BasicPlayer<Board> Player;
+
+// result of parsing a typed coordinate
+enum CoordinateStatus
+{
+    COORD_OK,
+    COORD_BAD_FORMAT, // not a letter followed by a number
+    COORD_BAD_ROW,    // row letter past the last row
+    COORD_BAD_COLUMN  // column number outside 1..Board::WIDTH
+};
+
+// Parses a coordinate such as "C4" (row letter, then column number) into pos; never throws
+CoordinateStatus parseCoordinate(const std::string &text, Position &pos);
+// Parses a ship direction: left, right, up, down or their first letters, in any case
+bool parseDirection(const std::string &text, Direction &dir);
+
 // class to handle display
 class UI
 {
+private:
+    static bool turbo; // when set, delays and animations are skipped
+
 public:
+    static void setTurbo(bool enabled);
+    static bool isTurbo();
     static void clearScreen();
     static void delay(int milliseconds);
     static void Battleshiplogo();
     static void Battleshiplogo2();
     static void drawGameBoard(const Player &player, const Player &opponent);
     static void displayGameRules();
-    static void displayMainMenu(bool cpuSmartMode);
+    static void displayMainMenu(const std::string &cpuIntelligence);
     static void displayShipPlacementMenu();
     static void displayGameOver(const Player &player, const Player &cpu);
     static Position getPlayerTarget();
@@ -107,4 +244,290 @@ public:
     static void spinner(int durationMs);
 };
 
-#endif
\ No newline at end of file
+// BasicShip implementation
+// The default ship is an empty slot in a fleet container.
+template <int Width, int Height, int MaxLength>
+BasicShip<Width, Height, MaxLength>::BasicShip() : type(' '), length(0), hitsRemaining(0), mask(0) {}
+
+// Constructs a ship with a given type and length.
+template <int Width, int Height, int MaxLength>
+BasicShip<Width, Height, MaxLength>::BasicShip(char shipType, int shipLength)
+    : type(shipType), length(shipLength), hitsRemaining(shipLength), mask(0) {}
+
+// Records a hit on the ship, decrementing hitsRemaining.
+template <int Width, int Height, int MaxLength>
+void BasicShip<Width, Height, MaxLength>::hit()
+{
+    if (hitsRemaining > 0)
+    {
+        hitsRemaining--;
+    }
+}
+
+// Adds a position to the ship's list of occupied positions.
+template <int Width, int Height, int MaxLength>
+void BasicShip<Width, Height, MaxLength>::addPosition(const Position &pos)
+{
+    if (positions.full())
+    {
+        return;
+    }
+    positions.push_back(pos);
+    mask |= singleCell<Mask>(pos.y * Width + pos.x);
+}
+
+// BasicBoard implementation
+// Constructs an empty board.
+template <int Width, int Height, int MaxShips, int MaxShipLength>
+BasicBoard<Width, Height, MaxShips, MaxShipLength>::BasicBoard()
+{
+    clearBoard();
+}
+
+// Clears the board, emptying every cell and removing all ships.
+template <int Width, int Height, int MaxShips, int MaxShipLength>
+void BasicBoard<Width, Height, MaxShips, MaxShipLength>::clearBoard()
+{
+    shipCells = 0;
+    hitCells = 0;
+    missCells = 0;
+    stateHash = 0;
+    ships.clear();
+    for (auto &index : shipAt)
+    {
+        index = -1;
+    }
+}
+
+// Gets the character at a specific cell on the board.
+// The character is derived from the cell masks: shot markers first, then the ship type.
+template <int Width, int Height, int MaxShips, int MaxShipLength>
+char BasicBoard<Width, Height, MaxShips, MaxShipLength>::getCell(int x, int y) const
+{
+    if (!contains(x, y))
+    {
+        return ' ';
+    }
+
+    Mask bit = singleCell<Mask>(y * Width + x);
+    if (hitCells & bit)
+        return HIT_CHAR;
+    if (missCells & bit)
+        return MISS_CHAR;
+    if (shipCells & bit)
+        return ships[shipAt[y * Width + x]].getType();
+    return EMPTY_CHAR;
+}
+
+// Sets the character at a specific cell on the board.
+// Only shot markers (HIT_CHAR, MISS_CHAR) and EMPTY_CHAR are stored; ship cells are set by placeShip.
+template <int Width, int Height, int MaxShips, int MaxShipLength>
+void BasicBoard<Width, Height, MaxShips, MaxShipLength>::setCell(int x, int y, char value)
+{
+    if (!contains(x, y))
+    {
+        return;
+    }
+
+    int index = y * Width + x;
+    Mask bit = singleCell<Mask>(index);
+    if (hitCells & bit)
+        stateHash ^= zobristKey(index, ZOBRIST_HIT);
+    if (missCells & bit)
+        stateHash ^= zobristKey(index, ZOBRIST_MISS);
+
+    if (value == HIT_CHAR)
+    {
+        hitCells |= bit;
+        missCells &= ~bit;
+    }
+    else if (value == MISS_CHAR)
+    {
+        missCells |= bit;
+        hitCells &= ~bit;
+    }
+    else if (value == EMPTY_CHAR)
+    {
+        hitCells &= ~bit;
+        missCells &= ~bit;
+    }
+
+    if (hitCells & bit)
+        stateHash ^= zobristKey(index, ZOBRIST_HIT);
+    if (missCells & bit)
+        stateHash ^= zobristKey(index, ZOBRIST_MISS);
+}
+
+// Checks if a specific cell on the board is empty.
+template <int Width, int Height, int MaxShips, int MaxShipLength>
+bool BasicBoard<Width, Height, MaxShips, MaxShipLength>::isEmptyCell(int x, int y) const
+{
+    if (!contains(x, y))
+    {
+        return false;
+    }
+    return !((shipCells | hitCells | missCells) & singleCell<Mask>(y * Width + x));
+}
+
+// Looks up the placement table entry for a ship of the given length starting at (x, y).
+// LEFT and UP ships are normalised to their top-left end. Returns -1 if the ship leaves the board.
+template <int Width, int Height, int MaxShips, int MaxShipLength>
+int BasicBoard<Width, Height, MaxShips, MaxShipLength>::findPlacement(int x, int y, int length, Direction dir)
+{
+    switch (dir)
+    {
+    case LEFT:
+        return Placements::index(x - length + 1, y, length, false);
+    case RIGHT:
+        return Placements::index(x, y, length, false);
+    case UP:
+        return Placements::index(x, y - length + 1, length, true);
+    case DOWN:
+        return Placements::index(x, y, length, true);
+    }
+    return -1;
+}
+
+// Checks if a ship placement is valid.
+template <int Width, int Height, int MaxShips, int MaxShipLength>
+bool BasicBoard<Width, Height, MaxShips, MaxShipLength>::isValidPlacement(int x, int y, int length, Direction dir) const
+{
+    int index = findPlacement(x, y, length, dir);
+    if (index < 0)
+    {
+        return false;
+    }
+    return !(Placements::ENTRIES[index].mask & (shipCells | hitCells | missCells));
+}
+
+// Places a ship on the board; the caller checks the placement with isValidPlacement first.
+template <int Width, int Height, int MaxShips, int MaxShipLength>
+void BasicBoard<Width, Height, MaxShips, MaxShipLength>::placeShip(ShipType &ship, int x, int y, Direction dir)
+{
+    int index = findPlacement(x, y, ship.getLength(), dir);
+    if (index < 0 || ships.full())
+    {
+        return;
+    }
+
+    for (Mask cells = Placements::ENTRIES[index].mask; cells; clearLowestCell(cells))
+    {
+        int cell = lowestCell(cells);
+        ship.addPosition(Position(cell % Width, cell / Width));
+    }
+
+    for (Mask cells = ship.getMask(); cells; clearLowestCell(cells))
+    {
+        shipAt[lowestCell(cells)] = static_cast<signed char>(ships.size());
+    }
+    shipCells |= ship.getMask();
+    ships.push_back(ship);
+}
+
+// Places the ships of a fleet randomly on the board.
+// Each ship is drawn uniformly from the placements that are still free, so there are no retries,
+// and all randomness comes from the caller's generator: the same seed gives the same fleet.
+template <int Width, int Height, int MaxShips, int MaxShipLength>
+void BasicBoard<Width, Height, MaxShips, MaxShipLength>::placeRandomShips(const Fleet &fleet, Rng &rng)
+{
+    int candidates[Placements::TOTAL];
+
+    for (int i = 0; i < fleet.size && !ships.full(); i++)
+    {
+        const ShipDef &def = fleet.ships[i];
+        if (def.length < 1 || def.length > MaxShipLength)
+        {
+            return; // this board cannot hold a ship of that length
+        }
+        Mask blocked = shipCells | hitCells | missCells;
+
+        // Collect the free placements of this length from the precomputed table
+        int count = 0;
+        for (int p = Placements::begin(def.length); p < Placements::end(def.length); p++)
+        {
+            if (!(Placements::ENTRIES[p].mask & blocked))
+                candidates[count++] = p;
+        }
+        if (count == 0)
+        {
+            return; // the board is too full for this fleet
+        }
+
+        const typename Placements::Entry &chosen = Placements::ENTRIES[candidates[rng.below(count)]];
+        ShipType ship(def.type, def.length);
+        placeShip(ship, chosen.origin % Width, chosen.origin / Width, chosen.vertical ? DOWN : RIGHT);
+    }
+}
+
+// Places the classic player fleet, or the classic enemy fleet if isEnemyBoard is set.
+template <int Width, int Height, int MaxShips, int MaxShipLength>
+void BasicBoard<Width, Height, MaxShips, MaxShipLength>::placeRandomShips(bool isEnemyBoard, Rng &rng)
+{
+    placeRandomShips(isEnemyBoard ? CLASSIC_ENEMY_FLEET : CLASSIC_PLAYER_FLEET, rng);
+}
+
+// Processes a shot at a given coordinate.
+// Reports a miss, a hit, or the sinking of a ship; shots outside the board or at cells
+// that were already fired upon are reported as such and change nothing.
+template <int Width, int Height, int MaxShips, int MaxShipLength>
+ShotResult BasicBoard<Width, Height, MaxShips, MaxShipLength>::processShot(int x, int y)
+{
+    ShotResult result = {SHOT_INVALID, 0, false};
+    if (!contains(x, y))
+    {
+        return result;
+    }
+
+    int index = y * Width + x;
+    Mask bit = singleCell<Mask>(index);
+
+    // Already shot here
+    if ((hitCells | missCells) & bit)
+    {
+        result.outcome = SHOT_ALREADY_TAKEN;
+        return result;
+    }
+
+    // miss
+    if (!(shipCells & bit))
+    {
+        missCells |= bit;
+        stateHash ^= zobristKey(index, ZOBRIST_MISS);
+        result.outcome = SHOT_MISS;
+        return result;
+    }
+
+    // hit: the cell index leads straight to the ship
+    hitCells |= bit;
+    stateHash ^= zobristKey(index, ZOBRIST_HIT);
+    ShipType &ship = ships[shipAt[index]];
+    ship.hit();
+
+    result.shipType = ship.getType();
+    result.outcome = ship.isDestroyed() ? SHOT_SUNK : SHOT_HIT;
+    result.gameOver = result.outcome == SHOT_SUNK && !(shipCells & ~hitCells);
+    return result;
+}
+
+// Checks if all ships on the board have been destroyed.
+template <int Width, int Height, int MaxShips, int MaxShipLength>
+bool BasicBoard<Width, Height, MaxShips, MaxShipLength>::allShipsDestroyed() const
+{
+    return !ships.empty() && !(shipCells & ~hitCells);
+}
+
+// Checks if a specific ship type has been destroyed.
+template <int Width, int Height, int MaxShips, int MaxShipLength>
+bool BasicBoard<Width, Height, MaxShips, MaxShipLength>::isShipDestroyed(char shipType) const
+{
+    for (const auto &ship : ships)
+    {
+        if (ship.getType() == shipType)
+        {
+            return !(ship.getMask() & ~hitCells);
+        }
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,4 @@
+#include "engine.h"
+
+// The classic engine is compiled here once
+template class BasicGameEngine<Board>;
\ No newline at end of file
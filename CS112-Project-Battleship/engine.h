@@ -0,0 +1,131 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+#include "player.h"
+#include "board.h"
+#include "record.h"
+#include <string>
+#include <type_traits>
+
+// sides of a game, used to index GameEngine players
+const int FIRST_SIDE = 0;
+const int SECOND_SIDE = 1;
+
+// Headless rules engine: applies shots, alternates turns and detects the winner.
+// It does no I/O and never sleeps, so games can be played as fast as the CPU allows.
+// BoardType sets the board size; GameEngine is the classic 8x8 game.
+template <class BoardType>
+class BasicGameEngine
+{
+public:
+    typedef BasicPlayer<BoardType> PlayerType;
+
+private:
+    PlayerType players[2];
+    int currentSide;
+    int winner; // -1 while the game is running
+    int shotsFired[2];
+    int winningScore;
+    GameRecord *record; // receives every shot that changes the game, if set
+
+public:
+    // scoreToWin is the number of hits that wins; pass fleet.cells() for a custom fleet
+    BasicGameEngine(const std::string &firstName, const std::string &secondName, int scoreToWin = CLASSIC_WINNING_SCORE);
+
+    void reset(); // clear boards and scores; ships are placed by the caller
+
+    PlayerType &getPlayer(int side) { return players[side]; }
+    const PlayerType &getPlayer(int side) const { return players[side]; }
+    int getCurrentSide() const { return currentSide; }
+    bool isGameOver() const { return winner != -1; }
+    int getWinner() const { return winner; }
+    int getShotsFired(int side) const { return shotsFired[side]; }
+    int getWinningScore() const { return winningScore; }
+
+    // Sends every shot that changes the game to record (nullptr to stop); classic boards only
+    void setRecord(GameRecord *gameRecord)
+    {
+        static_assert(std::is_same<BoardType, Board>::value, "game records hold classic 8x8 games");
+        record = gameRecord;
+    }
+
+    // Fire a shot for the given side, ignoring turn order
+    ShotResult fire(int side, int x, int y);
+    // Fire a shot for the side to move; a hit keeps the turn, a miss passes it
+    ShotResult step(int x, int y);
+    // The side to move gives up its shot and the turn passes. For a strategy that picked a cell it
+    // cannot fire at: step changes nothing then, so retrying would never end the turn.
+    void forfeit()
+    {
+        if (!isGameOver())
+            currentSide = 1 - currentSide;
+    }
+};
+
+typedef BasicGameEngine<Board> GameEngine;
+extern template class BasicGameEngine<Board>;
+
+// BasicGameEngine implementation: the rules of a game without any console I/O
+template <class BoardType>
+BasicGameEngine<BoardType>::BasicGameEngine(const std::string &firstName, const std::string &secondName, int scoreToWin)
+    : players{PlayerType(firstName), PlayerType(secondName)}, currentSide(FIRST_SIDE), winner(-1), shotsFired{0, 0}, winningScore(scoreToWin), record(nullptr) {}
+
+// Clears all four boards and both scores, and gives the first turn to FIRST_SIDE
+template <class BoardType>
+void BasicGameEngine<BoardType>::reset()
+{
+    for (auto &p : players)
+    {
+        p.getOwnBoard().clearBoard();
+        p.getTrackingBoard().clearBoard();
+        p.resetScore();
+    }
+    currentSide = FIRST_SIDE;
+    winner = -1;
+    shotsFired[FIRST_SIDE] = 0;
+    shotsFired[SECOND_SIDE] = 0;
+}
+
+// Fires at (x, y) on behalf of side and reports what happened.
+// Invalid and repeated shots leave the game state untouched.
+template <class BoardType>
+ShotResult BasicGameEngine<BoardType>::fire(int side, int x, int y)
+{
+    if (isGameOver())
+    {
+        ShotResult result = {SHOT_INVALID, 0, false};
+        return result;
+    }
+
+    PlayerType &attacker = players[side];
+    ShotResult result = attacker.attack(players[1 - side], x, y);
+    if (result.outcome == SHOT_INVALID || result.outcome == SHOT_ALREADY_TAKEN)
+    {
+        return result;
+    }
+
+    shotsFired[side]++;
+    if (record)
+    {
+        record->addShot(side, x, y, result);
+    }
+    if (result.gameOver || attacker.getScore() >= winningScore)
+    {
+        winner = side;
+        result.gameOver = true;
+    }
+    return result;
+}
+
+// Fires for the side whose turn it is, then passes the turn on a miss
+template <class BoardType>
+ShotResult BasicGameEngine<BoardType>::step(int x, int y)
+{
+    ShotResult result = fire(currentSide, x, y);
+    if (result.outcome == SHOT_MISS)
+    {
+        currentSide = 1 - currentSide;
+    }
+    return result;
+}
+
+#endif
\ No newline at end of file
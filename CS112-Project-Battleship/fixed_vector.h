@@ -0,0 +1,36 @@
+#ifndef FIXED_VECTOR_H
+#define FIXED_VECTOR_H
+
+#include <cstddef>
+
+// A vector with inline storage for at most N elements.
+// It never allocates, so copying or resetting an object that holds one is a plain memory copy.
+// T must be default-constructible; callers check full() before push_back.
+template <class T, std::size_t N>
+class FixedVector
+{
+private:
+    T items[N];
+    std::size_t count;
+
+public:
+    FixedVector() : count(0) {}
+
+    void push_back(const T &value) { items[count++] = value; }
+    void clear() { count = 0; }
+
+    std::size_t size() const { return count; }
+    static constexpr std::size_t capacity() { return N; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == N; }
+
+    T &operator[](std::size_t index) { return items[index]; }
+    const T &operator[](std::size_t index) const { return items[index]; }
+
+    T *begin() { return items; }
+    T *end() { return items + count; }
+    const T *begin() const { return items; }
+    const T *end() const { return items + count; }
+};
+
+#endif
@@ -4,7 +4,6 @@
 
 #include <iostream>
 #include <cstdlib>
-#include <ctime>
 #include <string>
 #include <vector>
 #include <algorithm>
@@ -13,7 +12,15 @@ using namespace std;
 
 // Game class implementation for Battleship game logic
 // Handles game setup, player and CPU turns, AI logic, and main game loop
-Game::Game() : player("Player"), cpu("CPU"), gameOver(false), cpuSmartMode(true), hunting(false) {}
+Game::Game(std::uint64_t sessionSeed) : engine("Player", "CPU"), player(engine.getPlayer(FIRST_SIDE)), cpu(engine.getPlayer(SECOND_SIDE)), gameOver(false),
+               baseSeed(sessionSeed), cpuStrategy(CPU_HUNT),
+               cpuAi(makeTargetingStrategy(CPU_HUNT)) {}
+
+// Records every game played from now on to writer; nullptr stops recording
+void Game::setRecorder(RecordWriter *writer)
+{
+    recorder = writer;
+}
 
 // Returns the full ship name based on type and owner (player or enemy)
 std::string Game::getFullShipName(char shipType, bool isEnemy)
@@ -59,18 +66,15 @@ std::string Game::getFullShipName(char shipType, bool isEnemy)
 // Sets up a new game: clears boards, resets scores, places ships
 void Game::initialize()
 {
-    player.getOwnBoard().clearBoard();
-    player.getTrackingBoard().clearBoard();
-    cpu.getOwnBoard().clearBoard();
-    cpu.getTrackingBoard().clearBoard();
-
-    player.resetScore();
-    cpu.resetScore();
-
-    playerShipsSunkThisGame.clear();
-    cpuShipsSunkThisGame.clear();
-
-    cpu.getOwnBoard().placeRandomShips(true);
+    engine.reset();
+    cpuAi->reset();
+    seed = deriveSeed(baseSeed, gamesPlayed++);
+    sideRng[FIRST_SIDE].reseed(deriveSeed(seed, FIRST_SIDE));
+    sideRng[SECOND_SIDE].reseed(deriveSeed(seed, SECOND_SIDE));
+    record.begin(seed, RECORD_INPUT, cpuStrategy);
+    engine.setRecord(recorder ? &record : nullptr);
+
+    cpu.getOwnBoard().placeRandomShips(true, sideRng[SECOND_SIDE]);
     placePlayerShips();
     if (gameOver)
         return;
@@ -78,6 +82,19 @@ void Game::initialize()
     gameOver = false;
 }
 
+// Writes the game that just ended, with both fleets and every shot, to the recorder
+void Game::saveRecord()
+{
+    if (!recorder)
+    {
+        return;
+    }
+    record.setFleet(FIRST_SIDE, player.getOwnBoard());
+    record.setFleet(SECOND_SIDE, cpu.getOwnBoard());
+    record.finish(engine.getWinner());
+    recorder->write(record);
+}
+
 // Presents ship placement menu and handles user choice
 void Game::placePlayerShips()
 {
@@ -88,6 +105,11 @@ void Game::placePlayerShips()
         UI::displayShipPlacementMenu();
         if (!(std::cin >> choice))
         {
+            if (std::cin.eof())
+            {
+                gameOver = true; // input ended: back out to the menu
+                return;
+            }
             std::cout << "\tInvalid input. Please enter a number.\n";
             UI::clearInputBuffer();
             UI::delay(1000);
@@ -96,7 +118,7 @@ void Game::placePlayerShips()
         switch (choice)
         {
         case 1:
-            player.getOwnBoard().placeRandomShips(false);
+            player.getOwnBoard().placeRandomShips(false, sideRng[FIRST_SIDE]);
             UI::clearScreen();
             UI::displayPlayerBoard(player.getOwnBoard());
             std::cout << "\n\tShips placed randomly. Press Enter to continue...";
@@ -196,19 +218,25 @@ void Game::manualShipPlacement()
     std::cin.get();
 }
 
-// Returns valid adjacent positions for smart CPU targeting
-std::vector<Position> Game::getAdjacentPositions(const Board &board, int x, int y)
+// Prints the outcome of a shot and announces a sunk ship
+void Game::reportShot(const ShotResult &result, bool playerShot)
 {
-    std::vector<Position> adj;
-    if (x > 0)
-        adj.push_back(Position(x - 1, y));
-    if (x < BOARD_SIZE - 1)
-        adj.push_back(Position(x + 1, y));
-    if (y > 0)
-        adj.push_back(Position(x, y - 1));
-    if (y < BOARD_SIZE - 1)
-        adj.push_back(Position(x, y + 1));
-    return adj;
+    if (result.outcome == SHOT_MISS)
+    {
+        std::cout << "MISS!\n";
+        UI::delay(1000);
+        return;
+    }
+
+    std::cout << "HIT!\n";
+    UI::delay(1000);
+    if (result.outcome == SHOT_SUNK)
+    {
+        // The engine reports a sink exactly once, on the shot that finishes the ship
+        std::string shipName = getFullShipName(result.shipType, playerShot);
+        UI::displayShipDestroyed(result.shipType, shipName,
+                                 playerShot ? "\n\t!!! ENEMY SHIP DESTROYED !!!\n\t" : "\n\t!!! YOUR SHIP DESTROYED !!!\n\t");
+    }
 }
 
 // Handles the player's attack turn, including input validation and feedback
@@ -225,222 +253,82 @@ void Game::playerTurn()
             gameOver = true;
             return;
         }
-        if (!target.isValid())
+
+        ShotResult result = engine.step(target.x, target.y);
+        if (result.outcome == SHOT_INVALID)
         {
             std::cout << "\tInvalid coordinates. Try again.\n";
             UI::delay(1000);
             continue;
         }
-        // Check if the cell has already been fired upon (is not empty or marked as water from a previous miss)
-        if (player.getTrackingBoard().getCell(target.x, target.y) != EMPTY_CHAR &&
-            player.getTrackingBoard().getCell(target.x, target.y) != WATER_CHAR) // Check against EMPTY_CHAR or specific water char
+        if (result.outcome == SHOT_ALREADY_TAKEN)
         {
             std::cout << "\tYou already fired at this position. Try again.\n";
             UI::delay(1000);
             continue;
         }
 
-        bool hit = player.attack(cpu, target.x, target.y);
         UI::drawGameBoard(player, cpu);
         std::cout << "\n\tTarget " << static_cast<char>('A' + target.y) << (target.x + 1) << ": ";
+        reportShot(result, true);
 
-        if (hit)
+        if (result.outcome == SHOT_MISS)
         {
-            std::cout << "HIT!\n";
-            UI::delay(1000);
-            // Check if any CPU ships were sunk by this hit
-            for (const auto &ship : cpu.getOwnBoard().getShips())
-            {
-                // Announce sunk ship only once per game
-                if (ship.isDestroyed() &&
-                    std::find(cpuShipsSunkThisGame.begin(), cpuShipsSunkThisGame.end(), ship.getType()) == cpuShipsSunkThisGame.end())
-                {
-                    cpuShipsSunkThisGame.push_back(ship.getType());
-                    std::string shipName = getFullShipName(ship.getType(), true); // true for enemy
-                    UI::displayShipDestroyed(ship.getType(), shipName, "\n\t!!! ENEMY SHIP DESTROYED !!!\n\t");
-                }
-            }
-            // Check for win condition
-            if (player.getScore() >= winningScore)
-            {
-                gameOver = true;
-                return;
-            }
-            // Player gets another turn if it was a hit
-            std::cout << "\n\tYou get another turn!\n";
-            UI::delay(1000);
+            break; // End player's turn on a miss
         }
-        else
+        // Check for win condition
+        if (result.gameOver)
         {
-            std::cout << "MISS!\n";
-            UI::delay(1000);
-            break; // End player's turn on a miss
+            gameOver = true;
+            return;
         }
+        // Player gets another turn if it was a hit
+        std::cout << "\n\tYou get another turn!\n";
+        UI::delay(1000);
     }
 }
 
-// Handles CPU's turn with random targeting (if not in smart mode)
+// Handles the CPU's turn; targeting is delegated to the strategy selected in the main menu, whose
+// decisions cpuLookahead has usually prepared during the player's turn
 void Game::cpuTurn()
 {
-    if (cpuSmartMode)
-    {
-        cpuSmartTurn(); // Use smart AI if enabled
-        return;
-    }
-
     UI::displayTurnIndicator(false);
     // Loop to allow CPU to take turns until a miss or game over
     while (true)
     {
-        int x, y;
-        // Randomly select coordinates until an untargeted cell is found
-        do
-        {
-            x = rand() % BOARD_SIZE;
-            y = rand() % BOARD_SIZE;
-        } while (cpu.getTrackingBoard().getCell(x, y) != EMPTY_CHAR &&
-                 cpu.getTrackingBoard().getCell(x, y) != WATER_CHAR); // Ensure cell hasn't been hit or missed before
-
-        std::string target_coord_str = std::string(1, static_cast<char>('A' + y)) + std::to_string(x + 1);
-        UI::loadingEffect("\n\tCPU targeting " + target_coord_str, 4, 500);
+        Position target = cpuLookahead.decide(cpuAi, cpu.getTrackingBoard(), sideRng[SECOND_SIDE]);
+        ShotResult result = engine.step(target.x, target.y);
+        cpuLookahead.record(*cpuAi, cpu.getTrackingBoard(), target, result, sideRng[SECOND_SIDE]);
 
-        bool hit = cpu.attack(player, x, y);
-        UI::drawGameBoard(player, cpu);
-        std::cout << "\n\tTarget " << target_coord_str << ": ";
-        UI::delay(700);
-        if (hit)
+        if (result.outcome == SHOT_INVALID || result.outcome == SHOT_ALREADY_TAKEN)
         {
-            std::cout << "HIT!\n";
+            // The strategy picked a cell it cannot fire at; retrying would never end the turn
+            engine.forfeit();
+            std::cout << "\n\tThe CPU picked a cell it cannot fire at and forfeits its turn.\n";
             UI::delay(1000);
-            // Check if any player ships were sunk by this hit
-            for (const auto &ship : player.getOwnBoard().getShips())
-            {
-                // Announce sunk ship only once per game
-                if (ship.isDestroyed() &&
-                    std::find(playerShipsSunkThisGame.begin(), playerShipsSunkThisGame.end(), ship.getType()) == playerShipsSunkThisGame.end())
-                {
-                    playerShipsSunkThisGame.push_back(ship.getType());
-                    std::string shipName = getFullShipName(ship.getType(), false);
-                    UI::displayShipDestroyed(ship.getType(), shipName, "\n\t!!! YOUR SHIP DESTROYED !!!\n\t");
-                }
-            }
-            // Check for win condition
-            if (cpu.getScore() >= winningScore)
-            {
-                gameOver = true;
-                return;
-            }
-            // CPU gets another turn if it was a hit
-            std::cout << "\n\tCPU gets another turn!\n";
-            UI::delay(1000);
-        }
-        else
-        {
-            std::cout << "MISS!\n";
-            UI::delay(1000);
-            break; // End CPU's turn on a miss
-        }
-    }
-}
-
-// Smart CPU turn: hunts for ships after a hit, otherwise fires randomly
-void Game::cpuSmartTurn()
-{
-    UI::displayTurnIndicator(false);
-    // Loop to allow CPU to take turns until a miss or game over
-    while (true)
-    {
-        int x = -1, y = -1;
-        // If in 'hunting' mode (a previous hit was made and adjacent targets are available)
-        if (hunting && !huntTargets.empty())
-        {
-            Position p = huntTargets.back(); // Get the most recently added hunt target
-            huntTargets.pop_back();
-            x = p.x;
-            y = p.y;
-            // If this hunt target has already been fired upon (e.g., by another path in hunting), skip and get next target
-            if (cpu.getTrackingBoard().getCell(x, y) != EMPTY_CHAR &&
-                cpu.getTrackingBoard().getCell(x, y) != WATER_CHAR)
-            {
-                continue;
-            }
-        }
-        else
-        {
-            // Not hunting or no hunt targets left, switch to random targeting
-            hunting = false;
-            // Randomly select coordinates until an untargeted cell is found
-            do
-            {
-                x = rand() % BOARD_SIZE;
-                y = rand() % BOARD_SIZE;
-            } while (cpu.getTrackingBoard().getCell(x, y) != EMPTY_CHAR &&
-                     cpu.getTrackingBoard().getCell(x, y) != WATER_CHAR); // Ensure cell hasn't been hit or missed before
+            break;
         }
 
-        std::string target_coord_str = std::string(1, static_cast<char>('A' + y)) + std::to_string(x + 1);
+        std::string target_coord_str = std::string(1, static_cast<char>('A' + target.y)) + std::to_string(target.x + 1);
         UI::loadingEffect("\n\tCPU targeting " + target_coord_str, 4, 500);
-
-        bool hit = cpu.attack(player, x, y);
         UI::drawGameBoard(player, cpu);
         std::cout << "\n\tTarget " << target_coord_str << ": ";
         UI::delay(700);
-        if (hit)
-        {
-            std::cout << "HIT!\n";
-            UI::delay(1000);
-            lastHit = Position(x, y); // Record the position of the successful hit
-            hunting = true;           // Switch to hunting mode
-            // Get adjacent positions to the hit cell as potential next targets
-            std::vector<Position> potentialTargets = getAdjacentPositions(player.getOwnBoard(), x, y);
-            for (const auto &pt : potentialTargets)
-            {
-                // Add to huntTargets only if it's a valid, untargeted cell and not already in huntTargets
-                if (cpu.getTrackingBoard().getCell(pt.x, pt.y) == EMPTY_CHAR ||
-                    cpu.getTrackingBoard().getCell(pt.x, pt.y) == WATER_CHAR)
-                {
-                    bool alreadyInTargets = false;
-                    for (const auto &ht : huntTargets)
-                        if (ht.x == pt.x && ht.y == pt.y)
-                        {
-                            alreadyInTargets = true;
-                            break;
-                        }
-                    if (!alreadyInTargets)
-                        huntTargets.push_back(pt);
-                }
-            }
+        reportShot(result, false);
 
-            // Check if any player ships were sunk by this hit
-            for (const auto &ship : player.getOwnBoard().getShips())
-            {
-                // Announce sunk ship only once per game
-                if (ship.isDestroyed() &&
-                    std::find(playerShipsSunkThisGame.begin(), playerShipsSunkThisGame.end(), ship.getType()) == playerShipsSunkThisGame.end())
-                {
-                    playerShipsSunkThisGame.push_back(ship.getType());
-                    std::string shipName = getFullShipName(ship.getType(), false); // false for player
-                    UI::displayShipDestroyed(ship.getType(), shipName, "\n\t!!! YOUR SHIP DESTROYED !!!\n\t");
-                }
-            }
-            // Check for win condition
-            if (cpu.getScore() >= winningScore)
-            {
-                gameOver = true;
-                return;
-            }
-            // CPU gets another turn if it was a hit
-            std::cout << "\n\tCPU gets another turn!\n";
-            UI::delay(1000);
-        }
-        else
+        if (result.outcome == SHOT_MISS)
         {
-            std::cout << "MISS!\n";
-            UI::delay(1000);
-            // On a miss, if there are no more hunt targets, hunting mode naturally ends on the next iteration.
-            // If there were hunt targets, the CPU will continue trying them.
             break; // End CPU's turn on a miss
         }
+        // Check for win condition
+        if (result.gameOver)
+        {
+            gameOver = true;
+            return;
+        }
+        // CPU gets another turn if it was a hit
+        std::cout << "\n\tCPU gets another turn!\n";
+        UI::delay(1000);
     }
 }
 
@@ -452,12 +340,16 @@ void Game::play()
     {
         return;
     }
+    // The CPU's first shot is prepared during the player's first turn; the demo has no CPU turns,
+    // so this is not done in initialize()
+    cpuLookahead.start(*cpuAi, cpu.getTrackingBoard(), sideRng[SECOND_SIDE]);
 
     while (!gameOver) // Loop continues as long as the game is not over
     {
         UI::drawGameBoard(player, cpu);
 
-        std::cout << "\n\tScore - Player: " << player.getScore() << "/17  CPU: " << cpu.getScore() << "/17\n";
+        std::cout << "\n\tScore - Player: " << player.getScore() << "/" << engine.getWinningScore()
+                  << "  CPU: " << cpu.getScore() << "/" << engine.getWinningScore() << "\n";
 
         playerTurn(); // playerTurn can set gameOver to true if player wins or quits
 
@@ -477,6 +369,7 @@ void Game::play()
     }
 
     // This block is now correctly reached when gameOver is true
+    saveRecord();
     UI::clearScreen();
     UI::displayGameOver(player, cpu); // Display who won or lost
     UI::clearInputBuffer();
@@ -492,9 +385,13 @@ void Game::run()
     {
         gameOver = false;
         UI::clearScreen();
-        UI::displayMainMenu(cpuSmartMode);
+        UI::displayMainMenu(cpuStrategyTitle(cpuStrategy));
         if (!(std::cin >> choice))
         {
+            if (std::cin.eof())
+            {
+                return; // input ended, e.g. a piped session ran out
+            }
             std::cout << "\tInvalid input. Please enter a number.\n";
             UI::clearInputBuffer();
             UI::delay(1500);
@@ -516,8 +413,10 @@ void Game::run()
             quickplayDemo(); // Run demo mode
             break;
         case 5:
-            cpuSmartMode = !cpuSmartMode; // Toggle AI mode
-            std::cout << "\n\tCPU Intelligence is now set to: " << (cpuSmartMode ? "Smart" : "Normal") << "\n";
+            cpuStrategy = static_cast<CpuStrategy>((cpuStrategy + 1) % CPU_STRATEGY_COUNT); // Cycle Normal -> Smart -> Expert -> Perfect -> Monte Carlo -> Anytime
+            cpuLookahead.stop();
+            cpuAi = makeTargetingStrategy(cpuStrategy);
+            std::cout << "\n\tCPU Intelligence is now set to: " << cpuStrategyTitle(cpuStrategy) << "\n";
             UI::delay(1500);
             break;
         default:
@@ -536,6 +435,7 @@ void Game::quickplayDemo()
     {
         return;
     }
+    record.begin(seed, RECORD_INPUT, RECORD_INPUT); // the demo's shots do not come from a strategy
 
     std::vector<Position> targets;
     // Collect all positions of player's ships to target them directly
@@ -566,31 +466,16 @@ void Game::quickplayDemo()
         if (gameOver)
             return;
 
-        char originalCell = player.getOwnBoard().getCell(pos.x, pos.y); // Get ship type before it's marked as HIT_CHAR
-        bool hit = cpu.attack(player, pos.x, pos.y);
+        ShotResult result = engine.fire(SECOND_SIDE, pos.x, pos.y);
 
         UI::drawGameBoard(player, cpu);
-        std::cout << "\n\tCPU Quickplay attack at " << static_cast<char>('A' + pos.y) << (pos.x + 1) << ": " << (hit ? "HIT!" : "MISS!") << "\n";
+        std::cout << "\n\tCPU Quickplay attack at " << static_cast<char>('A' + pos.y) << (pos.x + 1) << ": " << (result.outcome == SHOT_MISS ? "MISS!" : "HIT!") << "\n";
 
-        // Check if a ship part was hit and not already processed as a hit (originalCell != HIT_CHAR)
-        if (hit && originalCell != HIT_CHAR)
+        // Announce the ship this shot finished off
+        if (result.outcome == SHOT_SUNK)
         {
-            // Find the ship that was hit to announce its destruction if it's fully sunk
-            for (const auto &ship : player.getOwnBoard().getShips())
-            {
-                if (ship.getType() == originalCell) // Match ship type with the original cell content
-                {
-                    // Announce sunk ship only once per game
-                    if (ship.isDestroyed() &&
-                        std::find(playerShipsSunkThisGame.begin(), playerShipsSunkThisGame.end(), ship.getType()) == playerShipsSunkThisGame.end())
-                    {
-                        playerShipsSunkThisGame.push_back(ship.getType());
-                        std::string shipName = getFullShipName(ship.getType(), false);
-                        UI::displayShipDestroyed(ship.getType(), shipName, "\n\t!!! YOUR SHIP DESTROYED !!!\n\t");
-                    }
-                    break; // Found the ship, no need to check further
-                }
-            }
+            std::string shipName = getFullShipName(result.shipType, false);
+            UI::displayShipDestroyed(result.shipType, shipName, "\n\t!!! YOUR SHIP DESTROYED !!!\n\t");
         }
 
         std::cout << "\tPress Enter to continue or 'B' to go back... \n";
@@ -604,6 +489,7 @@ void Game::quickplayDemo()
     }
 
     gameOver = true;
+    saveRecord();
     UI::clearScreen();
     UI::displayGameOver(player, cpu);
     UI::clearInputBuffer();
@@ -2,38 +2,44 @@
 #define GAME_H
 #include "player.h"
 #include "board.h"
+#include "engine.h"
+#include "ai.h"
+#include "lookahead.h"
+#include "record.h"
 #include <vector> 
 #include <string> 
+#include <memory>
 
 
 class Game
 {
 private:
-    Player player;
-    Player cpu;
+    GameEngine engine; // rules and game state; Game is the console front end
+    Player &player;
+    Player &cpu;
     bool gameOver;
-    const int winningScore = 17;
 
-    // smarter cpu state
-    Position lastHit = Position(-1, -1);
+    // random sources: game n of the session is played from seed = deriveSeed(baseSeed, n), and each
+    // side draws its fleet placement and targeting from its own generator derived from that seed
+    std::uint64_t baseSeed;
+    unsigned int gamesPlayed = 0;
+    std::uint64_t seed = 0; // seed of the game in progress
+    Rng sideRng[2];
+    CpuStrategy cpuStrategy = CPU_RANDOM;   // selected CPU intelligence
+    std::unique_ptr<TargetingStrategy> cpuAi; // strategy object for cpuStrategy
+    Lookahead cpuLookahead;                   // prepares cpuAi's decisions while the player takes their turn
 
-    std::vector<Position> huntTargets;
-    bool hunting = false;
-   
-    bool cpuSmartMode = false; 
+    RecordWriter *recorder = nullptr; // where finished games are recorded, if set
+    GameRecord record;                // the game in progress
 
-    // To track announced sunk ships per game
-    std::vector<char> playerShipsSunkThisGame;
-    std::vector<char> cpuShipsSunkThisGame;
-
-    void cpuSmartTurn();
     void quickplayDemo();
     std::string getFullShipName(char shipType, bool isEnemy); // Helper to get full ship name
 
 
 // Constructor and main game execution method    
 public:
-    Game();
+    explicit Game(std::uint64_t sessionSeed);
+    void setRecorder(RecordWriter *writer); // record every game played from now on
     void run();
 
 // Game setup and turn-handling functions (initialization, ship placement, player & CPU turns, gameplay loop)
@@ -44,7 +50,8 @@ private:
     void playerTurn();
     void cpuTurn();
     void play();
-    std::vector<Position> getAdjacentPositions(const Board &board, int x, int y); // Retained for smart CPU
+    void reportShot(const ShotResult &result, bool playerShot); // Print the outcome of a shot
+    void saveRecord();                                          // Hand the finished game to the recorder
 };
 
 #endif
\ No newline at end of file
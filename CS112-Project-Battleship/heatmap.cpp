@@ -0,0 +1,327 @@
+#include "heatmap.h"
+#include "rng.h"
+
+#include <algorithm>
+#include <chrono>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define HEATMAP_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // Placements a byte counter can take before it may overflow (each adds at most MAX_SHIP_LENGTH)
+    const int FLUSH_INTERVAL = 255 / MAX_SHIP_LENGTH;
+    // Placements the 16-bit counters of the AVX2 kernel can take before they are weighted
+    const int MAX_RUN = 65535 / MAX_SHIP_LENGTH;
+
+    // Boards the calibration counts every placement on, passes over them per timing, and timings
+    // of each kernel
+    const int CALIBRATION_BOARDS = 8;
+    const int CALIBRATION_PASSES = 4;
+    const int CALIBRATION_ROUNDS = 10;
+    // A kernel replaces the scalar reference only if it is at least this much faster
+    const double CALIBRATION_MARGIN = 0.95;
+
+    // Reference kernel: walks the cells of each surviving placement
+    void countScalar(const Placement *placements, int count, Bitboard blocked, Bitboard unresolved, const int *weights,
+                     std::uint8_t *coverage, int *cover, int *hitCover)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            Bitboard mask = placements[i].mask;
+            if (mask & blocked)
+            {
+                coverage[i] = PLACEMENT_REMOVED;
+                continue;
+            }
+            int hits = popCount(mask & unresolved);
+            int weight = weights[placements[i].length];
+            coverage[i] = static_cast<std::uint8_t>(hits);
+            for (Bitboard cells = mask; cells; clearLowestCell(cells))
+            {
+                int cell = lowestCell(cells);
+                cover[cell] += weight;
+                hitCover[cell] += weight * hits;
+            }
+        }
+    }
+
+#ifdef HEATMAP_AVX2
+    // The AVX2 kernel keeps 64 byte counters in two registers in a transposed order: byte b of
+    // 64-bit lane q holds cell 8 * b + q in the first register and cell 8 * b + 4 + q in the
+    // second. A placement mask broadcast to every lane then only needs one AND and one compare
+    // per register to become 0xff in the bytes of the cells it covers, with no shuffles.
+    // Every FLUSH_INTERVAL placements the bytes are widened into 16-bit counters; at the end of
+    // each run of placements of one length those are weighted into 32-bit counters, and the
+    // 32-bit counters are put back in cell order once per call.
+    const std::uint64_t BYTE_BITS = 0x0101010101010101ULL;
+
+    // The counters of one output (cover or hitCover) at each width, all in the transposed order
+    struct LaneCounters
+    {
+        __m256i bytes[2];
+        __m256i words[4];  // word register 2h + k holds bytes 8k-8k+7 and 16+8k-16+8k+7 of byte register h
+        __m256i dwords[8]; // dword register 2w + k holds words 8k-8k+7 of word register w
+    };
+
+    __attribute__((target("avx2"))) inline void widenBytes(LaneCounters &counters)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        for (int h = 0; h < 2; h++)
+        {
+            counters.words[2 * h] = _mm256_add_epi16(counters.words[2 * h], _mm256_unpacklo_epi8(counters.bytes[h], zero));
+            counters.words[2 * h + 1] = _mm256_add_epi16(counters.words[2 * h + 1], _mm256_unpackhi_epi8(counters.bytes[h], zero));
+            counters.bytes[h] = zero;
+        }
+    }
+
+    __attribute__((target("avx2"))) inline void widenWords(LaneCounters &counters, int weight)
+    {
+        const __m256i factor = _mm256_set1_epi32(weight);
+        for (int w = 0; w < 4; w++)
+        {
+            __m256i low = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(counters.words[w]));
+            __m256i high = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(counters.words[w], 1));
+            counters.dwords[2 * w] = _mm256_add_epi32(counters.dwords[2 * w], _mm256_mullo_epi32(low, factor));
+            counters.dwords[2 * w + 1] = _mm256_add_epi32(counters.dwords[2 * w + 1], _mm256_mullo_epi32(high, factor));
+            counters.words[w] = _mm256_setzero_si256();
+        }
+    }
+
+    // Adds the 32-bit counters to out in cell order. Following a byte through the widening, dword
+    // register 4h + 2(q % 2) + q / 2 ends up holding column x = 4h + q of the board, one row per
+    // lane, so putting the cells back in order is an 8x8 transpose.
+    __attribute__((target("avx2"))) void addInCellOrder(const LaneCounters &counters, int *out)
+    {
+        static const int COLUMN_REGISTER[8] = {0, 2, 1, 3, 4, 6, 5, 7};
+        __m256i column[8], pairs[8], quads[8];
+        for (int x = 0; x < 8; x++)
+            column[x] = counters.dwords[COLUMN_REGISTER[x]];
+        for (int x = 0; x < 8; x += 2)
+        {
+            pairs[x] = _mm256_unpacklo_epi32(column[x], column[x + 1]);
+            pairs[x + 1] = _mm256_unpackhi_epi32(column[x], column[x + 1]);
+        }
+        for (int x = 0; x < 8; x += 4)
+        {
+            quads[x] = _mm256_unpacklo_epi64(pairs[x], pairs[x + 2]);
+            quads[x + 1] = _mm256_unpackhi_epi64(pairs[x], pairs[x + 2]);
+            quads[x + 2] = _mm256_unpacklo_epi64(pairs[x + 1], pairs[x + 3]);
+            quads[x + 3] = _mm256_unpackhi_epi64(pairs[x + 1], pairs[x + 3]);
+        }
+        for (int y = 0; y < 8; y++)
+        {
+            // rows 0-3 come from the low 128-bit halves, rows 4-7 from the high ones
+            __m256i row = y < 4 ? _mm256_permute2x128_si256(quads[y], quads[y + 4], 0x20)
+                                : _mm256_permute2x128_si256(quads[y - 4], quads[y], 0x31);
+            __m256i *target = reinterpret_cast<__m256i *>(out + 8 * y);
+            _mm256_storeu_si256(target, _mm256_add_epi32(_mm256_loadu_si256(target), row));
+        }
+    }
+
+    // Vector kernel: expands each placement into one byte per cell (0xff where covered) and
+    // accumulates those bytes, so a placement costs a handful of instructions whatever its length
+    __attribute__((target("avx2,popcnt"))) void countAvx2(const Placement *placements, int count, Bitboard blocked,
+                                                          Bitboard unresolved, const int *weights, std::uint8_t *coverage,
+                                                          int *cover, int *hitCover)
+    {
+        const __m256i selectLow = _mm256_setr_epi64x(static_cast<long long>(BYTE_BITS), static_cast<long long>(BYTE_BITS << 1),
+                                                     static_cast<long long>(BYTE_BITS << 2), static_cast<long long>(BYTE_BITS << 3));
+        const __m256i selectHigh = _mm256_slli_epi64(selectLow, 4);
+        LaneCounters covers, hitCovers;
+        for (LaneCounters *counters : {&covers, &hitCovers})
+        {
+            for (__m256i &v : counters->bytes)
+                v = _mm256_setzero_si256();
+            for (__m256i &v : counters->words)
+                v = _mm256_setzero_si256();
+            for (__m256i &v : counters->dwords)
+                v = _mm256_setzero_si256();
+        }
+        __m256i coverLow = covers.bytes[0], coverHigh = covers.bytes[1];
+        __m256i hitLow = hitCovers.bytes[0], hitHigh = hitCovers.bytes[1];
+
+        __m256i hitBytes[MAX_SHIP_LENGTH + 1];
+        for (int hits = 0; hits <= MAX_SHIP_LENGTH; hits++)
+            hitBytes[hits] = _mm256_set1_epi8(static_cast<char>(hits));
+
+        int i = 0;
+        while (i < count)
+        {
+            // One run of placements of the same length, and so the same weight
+            int length = placements[i].length;
+            int runEnd = i;
+            while (runEnd < count && runEnd - i < MAX_RUN && placements[runEnd].length == length)
+                runEnd++;
+
+            while (i < runEnd)
+            {
+                int chunkEnd = runEnd - i < FLUSH_INTERVAL ? runEnd : i + FLUSH_INTERVAL;
+                for (; i < chunkEnd; i++)
+                {
+                    // A ruled-out placement is expanded as an empty mask rather than skipped: mid-game
+                    // about half the placements are ruled out, and a branch on that mispredicts too often
+                    Bitboard mask = placements[i].mask;
+                    Bitboard keep = Bitboard(0) - Bitboard((mask & blocked) == 0); // all ones if the placement survives
+                    int hits = popCount(mask & unresolved);
+                    coverage[i] = static_cast<std::uint8_t>((hits & keep) | (PLACEMENT_REMOVED & ~keep));
+
+                    __m256i spread = _mm256_set1_epi64x(static_cast<long long>(mask & keep));
+                    __m256i low = _mm256_cmpeq_epi8(_mm256_and_si256(spread, selectLow), selectLow);
+                    __m256i high = _mm256_cmpeq_epi8(_mm256_and_si256(spread, selectHigh), selectHigh);
+                    coverLow = _mm256_sub_epi8(coverLow, low); // a covered byte is -1
+                    coverHigh = _mm256_sub_epi8(coverHigh, high);
+                    hitLow = _mm256_add_epi8(hitLow, _mm256_and_si256(low, hitBytes[hits]));
+                    hitHigh = _mm256_add_epi8(hitHigh, _mm256_and_si256(high, hitBytes[hits]));
+                }
+                covers.bytes[0] = coverLow;
+                covers.bytes[1] = coverHigh;
+                hitCovers.bytes[0] = hitLow;
+                hitCovers.bytes[1] = hitHigh;
+                widenBytes(covers);
+                widenBytes(hitCovers);
+                coverLow = coverHigh = hitLow = hitHigh = _mm256_setzero_si256();
+            }
+            widenWords(covers, weights[length]);
+            widenWords(hitCovers, weights[length]);
+        }
+        addInCellOrder(covers, cover);
+        addInCellOrder(hitCovers, hitCover);
+    }
+#endif
+}
+
+void countPlacements(const Placement *placements, int count, Bitboard blocked, Bitboard unresolved, const int *weights,
+                     std::uint8_t *coverage, int *cover, int *hitCover)
+{
+    countPlacementsWith(bestCountingKernel(), placements, count, blocked, unresolved, weights, coverage, cover, hitCover);
+}
+
+void countPlacementsWith(CountingKernel kernel, const Placement *placements, int count, Bitboard blocked,
+                         Bitboard unresolved, const int *weights, std::uint8_t *coverage, int *cover, int *hitCover)
+{
+#ifdef HEATMAP_AVX2
+    if (kernel == KERNEL_AVX2)
+    {
+        countAvx2(placements, count, blocked, unresolved, weights, coverage, cover, hitCover);
+        return;
+    }
+#endif
+    countScalar(placements, count, blocked, unresolved, weights, coverage, cover, hitCover);
+}
+
+namespace
+{
+    // Nanoseconds each kernel takes to count every placement on a few positions like those density
+    // targeting recounts (from a fixed seed: misses and a few hits, more shots on each board), the
+    // best of a few interleaved rounds so a burst of other work does not decide
+    void timeKernels(const bool *available, long long *nanoseconds)
+    {
+        Bitboard misses[CALIBRATION_BOARDS], hits[CALIBRATION_BOARDS];
+        Bitboard missed = 0, hit = 0;
+        Rng rng(CALIBRATION_BOARDS);
+        for (int board = 0; board < CALIBRATION_BOARDS; board++)
+        {
+            for (int shot = 0; shot < 4; shot++)
+            {
+                Bitboard cell = cellBit(static_cast<int>(rng.below(BOARD_SIZE * BOARD_SIZE)));
+                if ((missed | hit) & cell)
+                    continue;
+                if (rng.below(4) == 0)
+                    hit |= cell;
+                else
+                    missed |= cell;
+            }
+            misses[board] = missed;
+            hits[board] = hit;
+        }
+
+        static const int WEIGHTS[MAX_SHIP_LENGTH + 1] = {0, 0, 1, 2, 1, 1}; // the classic fleet afloat
+        std::uint8_t coverage[PLACEMENT_TOTAL];
+        int cover[BOARD_SIZE * BOARD_SIZE], hitCover[BOARD_SIZE * BOARD_SIZE];
+        for (int kernel = 0; kernel < KERNEL_COUNT; kernel++)
+            nanoseconds[kernel] = -1;
+        // Round 0 is not timed: it warms the caches and lets the CPU power up its vector units
+        for (int round = 0; round <= CALIBRATION_ROUNDS; round++)
+        {
+            for (int kernel = 0; kernel < KERNEL_COUNT; kernel++)
+            {
+                if (!available[kernel])
+                    continue;
+                auto start = std::chrono::steady_clock::now();
+                for (int pass = 0; pass < CALIBRATION_PASSES * CALIBRATION_BOARDS; pass++)
+                {
+                    int board = pass % CALIBRATION_BOARDS;
+                    std::fill(cover, cover + BOARD_SIZE * BOARD_SIZE, 0);
+                    std::fill(hitCover, hitCover + BOARD_SIZE * BOARD_SIZE, 0);
+                    countPlacementsWith(static_cast<CountingKernel>(kernel), PLACEMENTS.data(), PLACEMENT_TOTAL,
+                                        misses[board], hits[board], WEIGHTS, coverage, cover, hitCover);
+                }
+                long long elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                        std::chrono::steady_clock::now() - start)
+                                        .count();
+                if (round > 0 && (nanoseconds[kernel] < 0 || elapsed < nanoseconds[kernel]))
+                    nanoseconds[kernel] = elapsed;
+            }
+        }
+    }
+}
+
+bool isKernelAvailable(CountingKernel kernel)
+{
+    switch (kernel)
+    {
+    case KERNEL_SCALAR:
+        return true;
+    case KERNEL_AVX2:
+#ifdef HEATMAP_AVX2
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
+
+// The kernel that counted the calibration boards fastest on this machine, timed on first use.
+// Support for an instruction set says nothing about speed (AVX2 loses to scalar on some CPUs), so
+// the scalar reference is kept unless another kernel beats it by CALIBRATION_MARGIN.
+CountingKernel bestCountingKernel()
+{
+    static const CountingKernel best = []()
+    {
+        bool available[KERNEL_COUNT];
+        for (int kernel = 0; kernel < KERNEL_COUNT; kernel++)
+            available[kernel] = isKernelAvailable(static_cast<CountingKernel>(kernel));
+        long long nanoseconds[KERNEL_COUNT];
+        timeKernels(available, nanoseconds);
+        CountingKernel fastest = KERNEL_SCALAR;
+        long long limit = static_cast<long long>(nanoseconds[KERNEL_SCALAR] * CALIBRATION_MARGIN);
+        for (int kernel = 0; kernel < KERNEL_COUNT; kernel++)
+        {
+            if (available[kernel] && nanoseconds[kernel] < limit)
+            {
+                fastest = static_cast<CountingKernel>(kernel);
+                limit = nanoseconds[kernel];
+            }
+        }
+        return fastest;
+    }();
+    return best;
+}
+
+const char *countingKernelName(CountingKernel kernel)
+{
+    switch (kernel)
+    {
+    case KERNEL_SCALAR:
+        return "scalar";
+    case KERNEL_AVX2:
+        return "avx2";
+    default:
+        return "unknown";
+    }
+}
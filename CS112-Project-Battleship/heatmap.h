@@ -0,0 +1,43 @@
+#ifndef HEATMAP_H
+#define HEATMAP_H
+#include "placements.h"
+#include <cstdint>
+
+// Bulk placement counting, the inner loop of building a density heatmap from scratch.
+// Given a run of placements, the cells ruled out (misses and sunk ships) and the unresolved
+// hits, it drops every placement that touches a ruled-out cell and adds each survivor to the
+// counters of the cells it covers, once in cover and once per unresolved hit it contains in
+// hitCover.
+//
+// The scalar kernel is the reference. The AVX2 kernel expands each placement into 64 byte lanes
+// and accumulates 32 cells per instruction, widening the byte counters every few dozen
+// placements before one can overflow. Both give identical results. Which one is faster depends
+// on the CPU, not just on whether it has AVX2, so the first count times both on a few fixed
+// positions (about a millisecond) and keeps scalar unless AVX2 is clearly faster.
+
+// Placement coverage marking a placement that touches a ruled-out cell
+const std::uint8_t PLACEMENT_REMOVED = 0xff;
+
+enum CountingKernel
+{
+    KERNEL_SCALAR,
+    KERNEL_AVX2,
+    KERNEL_COUNT
+};
+
+// Counts placements[0..count), which must all cover at most MAX_SHIP_LENGTH cells. A placement
+// of length L weighs weights[L]. coverage[i] receives the unresolved hits inside placement i, or
+// PLACEMENT_REMOVED; cover and hitCover (one int per cell) are added to, each survivor
+// contributing its weight to the cells it covers in cover and its weight times its coverage in
+// hitCover. Runs of equal length are cheapest for the vector kernel, as in PLACEMENTS.
+void countPlacements(const Placement *placements, int count, Bitboard blocked, Bitboard unresolved, const int *weights,
+                     std::uint8_t *coverage, int *cover, int *hitCover);
+// The same with a chosen kernel, which must be available
+void countPlacementsWith(CountingKernel kernel, const Placement *placements, int count, Bitboard blocked,
+                         Bitboard unresolved, const int *weights, std::uint8_t *coverage, int *cover, int *hitCover);
+
+bool isKernelAvailable(CountingKernel kernel);
+CountingKernel bestCountingKernel(); // timed on first use
+const char *countingKernelName(CountingKernel kernel);
+
+#endif
@@ -0,0 +1,197 @@
+#include "lookahead.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace
+{
+    // The decisions a speculation prepares, in the order the worker makes them
+    enum PreparedDecision
+    {
+        PREPARED_NEXT,       // at the starting position
+        PREPARED_AFTER_HIT,  // after a hit on that decision's target
+        PREPARED_AFTER_MISS, // after a miss on it
+        PREPARED_COUNT,
+        PREPARED_NONE = -1
+    };
+}
+
+struct Lookahead::Speculation
+{
+    struct Decision
+    {
+        std::unique_ptr<TargetingStrategy> strategy; // the strategy once it has decided
+        Rng rng;                                      // its generator once it has decided
+        Position target;
+        std::uint64_t trackingHash = 0; // hash of the position decided at
+        bool ready = false;
+    };
+
+    std::mutex lock;
+    std::condition_variable changed;
+    Decision decisions[PREPARED_COUNT];
+    bool finished = false;               // the worker has made every decision it will make
+    std::atomic<bool> cancelled{false};  // nobody wants the rest of its decisions
+
+    void publish(int which, std::unique_ptr<TargetingStrategy> strategy, const Rng &rng, const Position &target,
+                 std::uint64_t trackingHash)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        Decision &decision = decisions[which];
+        decision.strategy = std::move(strategy);
+        decision.rng = rng;
+        decision.target = target;
+        decision.trackingHash = trackingHash;
+        decision.ready = true;
+        changed.notify_all();
+    }
+
+    void finish()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        finished = true;
+        changed.notify_all();
+    }
+
+    // Waits until deadline for decision which and moves it out if it was made at the position with
+    // trackingHash; returns false if it was not, if the worker finished without making it, or if it
+    // is still being made at the deadline
+    bool take(int which, std::uint64_t trackingHash, std::unique_ptr<TargetingStrategy> &strategy, Rng &rng,
+              Position &target, Deadline deadline)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        Decision &decision = decisions[which];
+        auto settled = [&]()
+        { return decision.ready || finished; };
+        if (deadline == Deadline::max())
+            changed.wait(guard, settled);
+        else
+            changed.wait_until(guard, deadline, settled);
+        if (!decision.ready || !decision.strategy || decision.trackingHash != trackingHash)
+            return false;
+        strategy = std::move(decision.strategy);
+        rng = decision.rng;
+        target = decision.target;
+        return true;
+    }
+};
+
+Lookahead::Lookahead() : expected(PREPARED_NONE) {}
+
+// Waits for every worker; a worker stops after the decision it is making
+Lookahead::~Lookahead()
+{
+    retire();
+    for (auto &worker : workers)
+        worker.second.join();
+}
+
+// Starts a worker on copies of strategy, tracking and rng. Unless the strategy has already decided
+// on target there, the worker first makes that decision; then it prepares the decisions after a
+// hit and after a miss on the target. The worker's decisions have no deadline of their own: they
+// may take as long as the player's turn lasts, and decide() stops waiting for them at the CPU's.
+void Lookahead::launch(const TargetingStrategy &strategy, const Board &tracking, const Rng &rng, bool decided,
+                       const Position &target)
+{
+    retire();
+    std::shared_ptr<Speculation> job = std::make_shared<Speculation>();
+    std::shared_ptr<TargetingStrategy> base(strategy.clone());
+    std::thread worker([job, base, tracking, generator = rng, decided, decision = target]() mutable
+                       {
+        if (!decided)
+        {
+            decision = base->chooseTargetBefore(tracking, generator, Deadline::max());
+            job->publish(PREPARED_NEXT, base->clone(), generator, decision, tracking.getStateHash());
+        }
+        const ShotOutcome outcomes[2] = {SHOT_HIT, SHOT_MISS};
+        for (int i = 0; i < 2 && !job->cancelled.load(); i++)
+        {
+            Board branch = tracking;
+            branch.setCell(decision.x, decision.y, outcomes[i] == SHOT_HIT ? HIT_CHAR : MISS_CHAR);
+            std::unique_ptr<TargetingStrategy> strategy = base->clone();
+            Rng branchRng = generator;
+            strategy->recordResult(branch, decision, ShotResult{outcomes[i], 0, false});
+            Position next = strategy->chooseTargetBefore(branch, branchRng, Deadline::max());
+            job->publish(PREPARED_AFTER_HIT + i, std::move(strategy), branchRng, next, branch.getStateHash());
+        }
+        job->finish(); });
+    workers.emplace_back(job, std::move(worker));
+    current = job;
+}
+
+// Drops the current speculation and joins the workers that have finished
+void Lookahead::retire()
+{
+    if (current)
+        current->cancelled.store(true);
+    current.reset();
+    expected = PREPARED_NONE;
+
+    for (std::size_t i = 0; i < workers.size();)
+    {
+        bool finished;
+        {
+            std::lock_guard<std::mutex> guard(workers[i].first->lock);
+            finished = workers[i].first->finished;
+        }
+        if (!finished)
+        {
+            i++;
+            continue;
+        }
+        workers[i].second.join();
+        workers[i] = std::move(workers.back());
+        workers.pop_back();
+    }
+}
+
+void Lookahead::start(const TargetingStrategy &strategy, const Board &tracking, const Rng &rng)
+{
+    launch(strategy, tracking, rng, false, Position());
+    expected = PREPARED_NEXT;
+}
+
+void Lookahead::stop()
+{
+    retire();
+}
+
+// Takes the prepared decision if there is one for tracking and it is ready within the move's
+// deadline, otherwise decides now with what is left of that deadline
+Position Lookahead::decide(std::unique_ptr<TargetingStrategy> &strategy, const Board &tracking, Rng &rng)
+{
+    Deadline deadline = moveDeadline();
+    Position target;
+    if (current && expected != PREPARED_NONE &&
+        current->take(expected, tracking.getStateHash(), strategy, rng, target, deadline))
+    {
+        if (expected == PREPARED_NEXT)
+        {
+            // the worker is already preparing what follows
+            expected = PREPARED_NONE;
+            return target;
+        }
+    }
+    else
+    {
+        target = strategy->chooseTargetBefore(tracking, rng, deadline);
+    }
+    launch(*strategy, tracking, rng, true, target);
+    return target;
+}
+
+// A hit or a miss selects the worker's decision for that outcome; after a sink the next decision
+// is started afresh, and a finished game needs none
+void Lookahead::record(TargetingStrategy &strategy, const Board &tracking, const Position &target,
+                       const ShotResult &result, const Rng &rng)
+{
+    strategy.recordResult(tracking, target, result);
+    if (result.gameOver)
+        retire();
+    else if (result.outcome == SHOT_HIT && current)
+        expected = PREPARED_AFTER_HIT;
+    else if (result.outcome == SHOT_MISS && current)
+        expected = PREPARED_AFTER_MISS;
+    else if (result.outcome == SHOT_SUNK)
+        start(strategy, tracking, rng);
+}
@@ -0,0 +1,65 @@
+#ifndef LOOKAHEAD_H
+#define LOOKAHEAD_H
+#include "ai.h"
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Background precomputation of the console CPU's moves.
+// While the human sits at the target prompt the CPU's tracking board cannot change, so its next
+// decision is already determined by the strategy's state, the board and its generator. A worker
+// thread makes that decision on copies of all three as soon as the CPU's turn ends, then the
+// decisions after a hit and after a miss on the target it picked: the first is the CPU's next
+// shot if it keeps its turn, the second its first shot of the following turn. When the CPU comes
+// to decide, the prepared strategy and generator are handed over and the target is ready.
+//
+// The worker's decisions have no deadline: they use the time the player spends at the prompt, and
+// decide() waits for one only until the CPU's own move deadline. A Perfect decision is therefore
+// a full count even in the opening, the same one chooseTarget makes, so a game whose prepared
+// decisions were all ready replays move for move. Anytime decisions run to their draw limit;
+// they and Monte Carlo decisions depend on time, so their games need not replay. A decision not
+// ready by the deadline is made on demand with what is left of it (Perfect falls back to the
+// Expert answer), and that game need not replay either.
+//
+// Speculating relies on a strategy's recordResult depending only on the outcome of a hit or a
+// miss, not on the ship hit, which the worker cannot know. A sink is not speculated on: the
+// decision after it is started once the sink is reported, during the pause before the CPU's
+// next shot.
+class Lookahead
+{
+private:
+    struct Speculation; // one worker's copies and the decisions it has made so far
+
+    std::shared_ptr<Speculation> current; // speculation the next decision is taken from, if any
+    int expected;                         // which of its decisions that is
+    // every worker started and not yet joined, with its speculation
+    std::vector<std::pair<std::shared_ptr<Speculation>, std::thread>> workers;
+
+    void launch(const TargetingStrategy &strategy, const Board &tracking, const Rng &rng, bool decided, const Position &target);
+    void retire();
+
+public:
+    Lookahead();
+    ~Lookahead();
+
+    Lookahead(const Lookahead &) = delete;
+    Lookahead &operator=(const Lookahead &) = delete;
+
+    // Starts preparing the decision strategy will make at tracking with rng (all three are copied)
+    void start(const TargetingStrategy &strategy, const Board &tracking, const Rng &rng);
+    // Abandons every prepared decision, e.g. because the strategy was reset
+    void stop();
+
+    // The target of strategy at tracking. A prepared decision is taken if there is one for this
+    // position and the worker finishes it before moveDeadline(), and strategy and rng are replaced
+    // by the worker's copies; otherwise the strategy decides now with what is left of that deadline.
+    // Speculation then continues from the decision made.
+    Position decide(std::unique_ptr<TargetingStrategy> &strategy, const Board &tracking, Rng &rng);
+    // Tells strategy the result of the shot it decided on last (tracking and rng as they are after
+    // it), and picks the prepared decision that follows from it
+    void record(TargetingStrategy &strategy, const Board &tracking, const Position &target, const ShotResult &result,
+                const Rng &rng);
+};
+
+#endif
@@ -1,17 +1,438 @@
 #include "game.h"
 #include "player.h"
 #include "board.h"
+#include "tournament.h"
+#include "record.h"
+#include "replay.h"
+#include "script.h"
+#include "ai.h"
 
 #include <iostream>
 #include <cstdlib>
-#include <ctime>
-int main()
+#include <fstream>
+#include <string>
+
+// Prints the command-line options
+static void printUsage(const char *program)
+{
+    std::cout << "Usage: " << program << " [--turbo] [--record FILE] [--seed S] [--budget MS] [--simulate GAMES [--threads N] [--first AI] [--second AI] [--csv FILE] [--json FILE]]\n"
+              << "       " << program << " [--record FILE] [--seed S] [--second AI] --script FILE\n"
+              << "       " << program << " --inspect FILE\n"
+              << "       " << program << " --replay FILE [--seed S]\n"
+              << "       " << program << " --show-game S [--first AI] [--second AI]\n"
+              << "  Without --simulate the interactive game starts.\n"
+              << "  --turbo           skip all delays and animations (also BATTLESHIP_TURBO=1)\n"
+              << "  --record FILE     append a binary record of every game played to FILE\n"
+              << "  --script FILE     play the scripted games in FILE ('-' for standard input) against the CPU;\n"
+              << "                    see script.h for the format\n"
+              << "  --inspect FILE    summarise the games in a record file\n"
+              << "  --replay FILE     re-run every recorded game from its seed and check it plays out the same;\n"
+              << "                    with --seed S, print and re-run only the game with seed S\n"
+              << "  --show-game S     print the self-play game with game seed S (e.g. a report's longest win)\n"
+              << "  --simulate GAMES  play GAMES CPU-vs-CPU games and print statistics\n"
+              << "  --threads N       worker threads (default: all cores)\n"
+              << "  --first AI        strategy of the first side: random, smart, expert, exact, sampling\n"
+              << "                    or anytime (default: smart)\n"
+              << "  --second AI       strategy of the second side: random, smart, expert, exact, sampling\n"
+              << "                    or anytime (default: smart)\n"
+              << "  --csv FILE        also write the simulation statistics to FILE as CSV\n"
+              << "  --json FILE       also write the simulation statistics and histograms to FILE as JSON\n"
+              << "  --seed S          base random seed of the session or run (default: fresh each run)\n"
+              << "  --budget MS       time budget of each CPU move in the console game and of each sampling\n"
+              << "                    (Monte Carlo) or anytime CPU decision (default: 100)\n";
+}
+
+// Parses a non-negative integer option value; returns false on malformed input
+static bool parseCount(const char *text, unsigned int &value)
+{
+    char *end = nullptr;
+    unsigned long parsed = std::strtoul(text, &end, 10);
+    if (end == text || *end != '\0' || text[0] == '-')
+        return false;
+    value = static_cast<unsigned int>(parsed);
+    return true;
+}
+
+// Parses a 64-bit seed option value; returns false on malformed input
+static bool parseSeed(const char *text, unsigned long long &value)
+{
+    char *end = nullptr;
+    value = std::strtoull(text, &end, 10);
+    return end != text && *end == '\0' && text[0] != '-';
+}
+
+// Parses a positive time in milliseconds; returns false on malformed input
+static bool parseMilliseconds(const char *text, double &value)
+{
+    char *end = nullptr;
+    value = std::strtod(text, &end);
+    return end != text && *end == '\0' && value > 0;
+}
+
+// Runs batch self-play from the command-line options; finished games go to recorder if it is set
+static int runSimulation(int argc, char *argv[], RecordWriter *recorder)
+{
+    TournamentConfig config;
+    config.games = 0;
+    config.threads = 0;
+    config.firstStrategy = CPU_HUNT;
+    config.secondStrategy = CPU_HUNT;
+    config.seed = freshSeed();
+    config.recorder = recorder;
+    const char *csvPath = nullptr;
+    const char *jsonPath = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool ok = hasValue;
+        if (option == "--turbo")
+            continue;
+        if ((option == "--record" || option == "--budget") && hasValue)
+            i++; // read by main
+        else if (option == "--simulate" && hasValue)
+            ok = parseCount(argv[++i], config.games) && config.games > 0;
+        else if (option == "--threads" && hasValue)
+            ok = parseCount(argv[++i], config.threads);
+        else if (option == "--seed" && hasValue)
+            ok = parseSeed(argv[++i], config.seed);
+        else if (option == "--first" && hasValue)
+            ok = parseCpuStrategy(argv[++i], config.firstStrategy);
+        else if (option == "--second" && hasValue)
+            ok = parseCpuStrategy(argv[++i], config.secondStrategy);
+        else if (option == "--csv" && hasValue)
+            csvPath = argv[++i];
+        else if (option == "--json" && hasValue)
+            jsonPath = argv[++i];
+        else
+            ok = false;
+
+        if (!ok)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (config.games == 0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    TournamentReport report = runTournament(config);
+    printTournamentReport(config, report, std::cout);
+
+    std::ofstream csv, json;
+    if (csvPath)
+    {
+        csv.open(csvPath);
+        writeStatsCsv(report.stats, csv);
+    }
+    if (jsonPath)
+    {
+        json.open(jsonPath);
+        writeStatsJson(report.stats, json);
+    }
+    if ((csvPath && !csv) || (jsonPath && !json))
+    {
+        std::cerr << "Cannot write the statistics file\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Plays the games of a script file against the CPU, one result line per game and a summary
+static int runScriptFile(int argc, char *argv[], RecordWriter *recorder)
+{
+    const char *path = nullptr;
+    ScriptConfig config;
+    config.seed = freshSeed();
+    config.cpuStrategy = CPU_HUNT;
+    config.recorder = recorder;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        bool ok = i + 1 < argc;
+        if (option == "--turbo")
+            continue;
+        if ((option == "--record" || option == "--budget") && ok)
+            i++; // read by main
+        else if (option == "--script" && ok)
+            path = argv[++i];
+        else if (option == "--seed" && ok)
+            ok = parseSeed(argv[++i], config.seed);
+        else if (option == "--second" && ok)
+            ok = parseCpuStrategy(argv[++i], config.cpuStrategy);
+        else
+            ok = false;
+        if (!ok)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::ifstream file;
+    if (std::string(path) != "-")
+    {
+        file.open(path);
+        if (!file)
+        {
+            std::cerr << "Cannot read script file " << path << "\n";
+            return 1;
+        }
+    }
+    std::istream &in = file.is_open() ? static_cast<std::istream &>(file) : std::cin;
+
+    ScriptSummary summary = runScript(in, config, std::cout);
+    std::cout << "Scripted games: " << summary.games << " played, player won " << summary.playerWins << ", cpu won "
+              << summary.cpuWins << ", unfinished " << summary.unfinished << ", malformed " << summary.errors << "\n";
+    return summary.errors ? 1 : 0;
+}
+
+// Reads a record file and prints how many games it holds and how they went.
+// Every shot is replayed from the stored fleets, so this also checks that the records are consistent.
+static int inspectRecords(const char *path)
+{
+    RecordReader reader;
+    if (!reader.open(path))
+    {
+        std::cerr << "Cannot read record file " << path << "\n";
+        return 1;
+    }
+
+    unsigned long long games = 0, bytes = 0, wins[2] = {0, 0}, shotsToWin = 0, inconsistent = 0;
+    for (RecordView game : reader)
+    {
+        games++;
+        bytes += game.size();
+        int winner = game.getWinner();
+        int winnerShots = 0;
+        bool ended = false;
+        game.forEachShot([&](const RecordedShot &shot)
+                         {
+            if (shot.side == winner)
+                winnerShots++;
+            ended = ended || shot.result.gameOver; });
+        if (ended != (winner >= 0))
+            inconsistent++;
+        if (winner >= 0)
+        {
+            wins[winner]++;
+            shotsToWin += winnerShots;
+        }
+    }
+
+    unsigned long long finished = wins[0] + wins[1];
+    std::cout << "Records in " << path << ": " << games << " games, " << bytes << " bytes"
+              << " (" << (games ? static_cast<double>(bytes) / games : 0) << " bytes/game)\n";
+    std::cout << "  wins:           first " << wins[0] << ", second " << wins[1] << ", unfinished " << games - finished << "\n";
+    std::cout << "  mean shots/win: " << (finished ? static_cast<double>(shotsToWin) / finished : 0) << "\n";
+    if (inconsistent)
+        std::cout << "  inconsistent:   " << inconsistent << " games whose shots do not match their winner\n";
+    return inconsistent ? 1 : 0;
+}
+
+// Replays the games of a record file from their seeds and reports the ones that play out differently.
+// With --seed S only the game with that seed is replayed, after printing it move by move.
+static int replayRecords(int argc, char *argv[])
 {
-    // random number generator with  time
-    srand(static_cast<unsigned int>(time(nullptr)));
+    const char *path = nullptr;
+    unsigned long long onlySeed = 0;
+    bool single = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        bool ok = i + 1 < argc;
+        if (option == "--turbo")
+            continue;
+        if (option == "--budget" && ok)
+            i++; // read by main
+        else if (option == "--replay" && ok)
+            path = argv[++i];
+        else if (option == "--seed" && ok)
+            ok = single = parseSeed(argv[++i], onlySeed);
+        else
+            ok = false;
+        if (!ok)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
 
-    Game battleship;  //  game instance
-    battleship.run(); // start the game
+    RecordReader reader;
+    if (!reader.open(path))
+    {
+        std::cerr << "Cannot read record file " << path << "\n";
+        return 1;
+    }
+
+    unsigned long long games = 0, identical = 0;
+    for (RecordView game : reader)
+    {
+        if (single && game.getSeed() != onlySeed)
+            continue;
+        games++;
+        if (single)
+            printGame(game, std::cout);
+
+        std::string difference;
+        if (replayGame(game, difference))
+            identical++;
+        else
+            std::cout << "Game seed " << game.getSeed() << " differs: " << difference << "\n";
+    }
+
+    if (single && games == 0)
+    {
+        std::cerr << "No game with seed " << onlySeed << " in " << path << "\n";
+        return 1;
+    }
+    std::cout << "Replayed " << games << " games from " << path << ": " << identical << " identical, "
+              << games - identical << " different\n";
+    return identical == games ? 0 : 1;
+}
+
+// Regenerates one self-play game from its game seed and prints it
+static int showSeededGame(int argc, char *argv[])
+{
+    unsigned long long seed = 0;
+    CpuStrategy first = CPU_HUNT, second = CPU_HUNT;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        bool ok = i + 1 < argc;
+        if (option == "--turbo")
+            continue;
+        if (option == "--budget" && ok)
+            i++; // read by main
+        else if (option == "--show-game" && ok)
+            ok = parseSeed(argv[++i], seed);
+        else if (option == "--first" && ok)
+            ok = parseCpuStrategy(argv[++i], first);
+        else if (option == "--second" && ok)
+            ok = parseCpuStrategy(argv[++i], second);
+        else
+            ok = false;
+        if (!ok)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
 
+    GameRecord record;
+    playSeededGame(first, second, seed, record);
+    unsigned char bytes[MAX_RECORD_BYTES];
+    record.encode(bytes);
+    printGame(RecordView(bytes), std::cout);
     return 0;
+}
+
+// True if BATTLESHIP_TURBO is set to anything other than empty or "0"
+static bool turboFromEnvironment()
+{
+    const char *value = std::getenv("BATTLESHIP_TURBO");
+    return value != nullptr && value[0] != '\0' && std::string(value) != "0";
+}
+
+// Applies a --budget option to the sampling strategy before any mode starts; returns false if it is malformed
+static bool readBudget(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string(argv[i]) != "--budget")
+            continue;
+        SamplingLimits limits = samplingLimits();
+        if (i + 1 >= argc || !parseMilliseconds(argv[i + 1], limits.milliseconds))
+            return false;
+        setSamplingLimits(limits);
+    }
+    return true;
+}
+
+// Scripts and replays play their games one after another, and each CPU decision stays on the
+// thread playing it (runTournament does the same for its workers); only the console CPU fans out
+// over every core
+static void decideOnOneThread()
+{
+    SamplingLimits limits = samplingLimits();
+    limits.threads = 1;
+    setSamplingLimits(limits);
+}
+
+int main(int argc, char *argv[])
+{
+    bool simulate = false;
+    bool script = false;
+    const char *recordPath = nullptr;
+    unsigned long long seed = freshSeed();
+    UI::setTurbo(turboFromEnvironment());
+    if (!readBudget(argc, argv))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+        if (option == "--turbo")
+            UI::setTurbo(true);
+        else if (option == "--record" && i + 1 < argc)
+            recordPath = argv[++i];
+        else if (option == "--inspect" && i + 1 < argc)
+            return inspectRecords(argv[i + 1]);
+        else if (option == "--replay")
+        {
+            decideOnOneThread();
+            return replayRecords(argc, argv);
+        }
+        else if (option == "--show-game")
+        {
+            decideOnOneThread();
+            return showSeededGame(argc, argv);
+        }
+        else if (option == "--seed" && i + 1 < argc && parseSeed(argv[i + 1], seed))
+            i++; // also read by runSimulation and runScriptFile
+        else if (option == "--budget")
+            i++; // read by readBudget
+        else if (option == "--script")
+            script = true;
+        else
+            simulate = true;
+    }
+
+    RecordWriter recorder;
+    if (recordPath && !recorder.open(recordPath))
+    {
+        std::cerr << "Cannot open record file " << recordPath << " (missing directory, or not a record file)\n";
+        return 1;
+    }
+    int status = 0;
+    if (script)
+    {
+        decideOnOneThread();
+        status = runScriptFile(argc, argv, recordPath ? &recorder : nullptr);
+    }
+    else if (simulate)
+    {
+        status = runSimulation(argc, argv, recordPath ? &recorder : nullptr);
+    }
+    else
+    {
+        Game battleship(seed); //  game instance; every game of the session derives its seed from this one
+        if (recordPath)
+            battleship.setRecorder(&recorder);
+        battleship.run(); // start the game
+    }
+
+    if (recordPath && !recorder.close())
+    {
+        std::cerr << "Failed to write record file " << recordPath << "\n";
+        return 1;
+    }
+    return status;
 }
\ No newline at end of file
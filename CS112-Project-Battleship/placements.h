@@ -0,0 +1,133 @@
+#ifndef PLACEMENTS_H
+#define PLACEMENTS_H
+
+#include "bitboard.h"
+#include <array>
+#include <cstdint>
+
+// Compile-time tables of every distinct ship placement on a board.
+// A placement is identified by its top-left cell, length and orientation, so a LEFT/UP ship
+// and the RIGHT/DOWN ship covering the same cells share one entry. Length-1 ships only get
+// horizontal entries because both orientations cover the same cell.
+// Entries are grouped by length, horizontal placements first, each group in row-major order.
+
+const int MAX_SHIP_LENGTH = 5;
+
+template <class Mask>
+struct BasicPlacement
+{
+    Mask mask;            // cells covered
+    std::uint16_t origin; // cell index of the top-left end
+    std::uint8_t length;
+    bool vertical;
+};
+
+// The placement table of a Width x Height board for ships of length 1 to MaxLength
+template <int Width, int Height, int MaxLength>
+struct PlacementTable
+{
+    typedef typename CellMask<Width * Height>::type Mask;
+    typedef BasicPlacement<Mask> Entry;
+
+    static_assert(Width * Height <= 65535, "cell indices are stored in 16 bits");
+
+    // Number of horizontal placements of a ship of the given length
+    static constexpr int horizontalCount(int length)
+    {
+        return length <= Width ? Height * (Width - length + 1) : 0;
+    }
+
+    // Number of distinct placements of a ship of the given length
+    static constexpr int count(int length)
+    {
+        if (length == 1)
+            return Width * Height;
+        return horizontalCount(length) + (length <= Height ? Width * (Height - length + 1) : 0);
+    }
+
+    // Index of the first placement of each length; entry MaxLength + 1 is the table size
+    static constexpr std::array<int, MaxLength + 2> buildOffsets()
+    {
+        std::array<int, MaxLength + 2> offsets{};
+        for (int length = 1; length <= MaxLength; length++)
+            offsets[length + 1] = offsets[length] + count(length);
+        return offsets;
+    }
+
+    static constexpr std::array<int, MaxLength + 2> OFFSETS = buildOffsets();
+    static constexpr int TOTAL = OFFSETS[MaxLength + 1];
+
+    static constexpr std::array<Entry, TOTAL> build()
+    {
+        std::array<Entry, TOTAL> table{};
+        for (int length = 1; length <= MaxLength; length++)
+        {
+            int next = OFFSETS[length];
+            for (int vertical = 0; vertical <= (length > 1 ? 1 : 0); vertical++)
+            {
+                int spanX = vertical ? 1 : length;
+                int spanY = vertical ? length : 1;
+                for (int y = 0; y + spanY <= Height; y++)
+                {
+                    for (int x = 0; x + spanX <= Width; x++)
+                    {
+                        Mask mask = 0;
+                        for (int i = 0; i < length; i++)
+                            mask |= singleCell<Mask>(vertical ? (y + i) * Width + x : y * Width + x + i);
+                        table[next].mask = mask;
+                        table[next].origin = static_cast<std::uint16_t>(y * Width + x);
+                        table[next].length = static_cast<std::uint8_t>(length);
+                        table[next].vertical = vertical != 0;
+                        next++;
+                    }
+                }
+            }
+        }
+        return table;
+    }
+
+    static constexpr std::array<Entry, TOTAL> ENTRIES = build();
+
+    // First and one-past-last table index of the placements of a ship length
+    static constexpr int begin(int length) { return OFFSETS[length]; }
+    static constexpr int end(int length) { return OFFSETS[length + 1]; }
+
+    // Table index of the placement whose top-left end is (x, y), or -1 if it leaves the board
+    static constexpr int index(int x, int y, int length, bool vertical)
+    {
+        if (length < 1 || length > MaxLength || x < 0 || y < 0)
+            return -1;
+        if (length == 1)
+            vertical = false;
+        if (!vertical)
+        {
+            if (x + length > Width || y >= Height)
+                return -1;
+            return begin(length) + y * (Width - length + 1) + x;
+        }
+        if (x >= Width || y + length > Height)
+            return -1;
+        return begin(length) + horizontalCount(length) + y * Width + x;
+    }
+};
+
+// The classic 8x8 table, used directly by the CPU strategies
+typedef PlacementTable<BOARD_SIZE, BOARD_SIZE, MAX_SHIP_LENGTH> ClassicPlacements;
+typedef ClassicPlacements::Entry Placement;
+
+const int PLACEMENT_TOTAL = ClassicPlacements::TOTAL;
+inline constexpr const std::array<Placement, PLACEMENT_TOTAL> &PLACEMENTS = ClassicPlacements::ENTRIES;
+
+constexpr int placementsBegin(int length) { return ClassicPlacements::begin(length); }
+constexpr int placementsEnd(int length) { return ClassicPlacements::end(length); }
+constexpr int placementIndex(int x, int y, int length, bool vertical)
+{
+    return ClassicPlacements::index(x, y, length, vertical);
+}
+
+static_assert(PLACEMENT_TOTAL == 416, "8x8 board with ships of length 1-5 has 416 placements");
+static_assert(PLACEMENTS[placementIndex(3, 2, 4, true)].mask ==
+                  (cellBit(cellIndex(3, 2)) | cellBit(cellIndex(3, 3)) | cellBit(cellIndex(3, 4)) | cellBit(cellIndex(3, 5))),
+              "placement lookup must agree with the table layout");
+
+#endif
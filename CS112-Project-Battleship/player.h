@@ -4,28 +4,55 @@
 #include <vector>
 #include "board.h"
 
-class Player
+// A player on boards of type BoardType; Player is the classic 8x8 one
+template <class BoardType>
+class BasicPlayer
 {
 private:
     std::string name;
-    Board ownBoard;
-    Board trackingBoard; // To track shots against opponent
+    BoardType ownBoard;
+    BoardType trackingBoard; // To track shots against opponent
     int score;
 
 public:
-    Player(const std::string &playerName); // Access player name
-
-    const std::string &getName() const;
-    int getScore() const;
-    void incrementScore(); // Increase score by one
-    void resetScore();
-
-    const Board &getOwnBoard() const;
-    const Board &getTrackingBoard() const;
-    Board &getOwnBoard(); // Modify own board
-    Board &getTrackingBoard();
-    // Perform attack on opponent at (x, y); returns true if hit
-    bool attack(Player &opponent, int x, int y);
+    BasicPlayer(const std::string &playerName); // Access player name
+
+    const std::string &getName() const { return name; }
+    int getScore() const { return score; }
+    void incrementScore() { score++; } // Increase score by one
+    void resetScore() { score = 0; }
+
+    const BoardType &getOwnBoard() const { return ownBoard; }
+    const BoardType &getTrackingBoard() const { return trackingBoard; }
+    BoardType &getOwnBoard() { return ownBoard; } // Modify own board
+    BoardType &getTrackingBoard() { return trackingBoard; }
+    // Perform attack on opponent at (x, y) and record it on the tracking board
+    ShotResult attack(BasicPlayer &opponent, int x, int y);
 };
 
+extern template class BasicPlayer<Board>;
+
+// Constructor initializes name and score
+template <class BoardType>
+BasicPlayer<BoardType>::BasicPlayer(const std::string &playerName) : name(playerName), score(0) {}
+
+// Attack opponent and update tracking board
+template <class BoardType>
+ShotResult BasicPlayer<BoardType>::attack(BasicPlayer &opponent, int x, int y)
+{
+    ShotResult result = opponent.getOwnBoard().processShot(x, y);
+
+    if (result.outcome == SHOT_HIT || result.outcome == SHOT_SUNK)
+    {
+        trackingBoard.setCell(x, y, HIT_CHAR);
+        incrementScore();
+    }
+    else if (result.outcome == SHOT_MISS)
+    {
+        trackingBoard.setCell(x, y, MISS_CHAR);
+    }
+
+    return result;
+}
+
 #endif
\ No newline at end of file
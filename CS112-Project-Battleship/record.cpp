@@ -0,0 +1,344 @@
+#include "record.h"
+
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const unsigned char FILE_MAGIC[4] = {'B', 'S', 'G', 'R'};
+    const unsigned char NO_WINNER = 0xff;
+
+    // Fills an 8-byte file header
+    void makeFileHeader(unsigned char *header)
+    {
+        std::memcpy(header, FILE_MAGIC, sizeof(FILE_MAGIC));
+        header[4] = RECORD_VERSION;
+        header[5] = header[6] = header[7] = 0;
+    }
+
+    bool isFileHeader(const unsigned char *header)
+    {
+        return std::memcmp(header, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0 && header[4] == RECORD_VERSION;
+    }
+}
+
+// GameRecord implementation
+GameRecord::GameRecord() : seed(0), players{RECORD_INPUT, RECORD_INPUT}, winner(-1) {}
+
+// Starts a new game, dropping the previous one
+void GameRecord::begin(std::uint64_t gameSeed, int firstPlayer, int secondPlayer)
+{
+    seed = gameSeed;
+    players[0] = firstPlayer;
+    players[1] = secondPlayer;
+    winner = -1;
+    fleets[0].clear();
+    fleets[1].clear();
+    shots.clear();
+}
+
+// Records the ships on a side's board in the order they were placed
+void GameRecord::setFleet(int side, const Board &board)
+{
+    fleets[side].clear();
+    for (const auto &ship : board.getShips())
+    {
+        Bitboard mask = ship.getMask();
+        if (!mask || fleets[side].full())
+            continue;
+        int origin = lowestCell(mask);
+        bool vertical = ship.getLength() > 1 && origin + BOARD_SIZE < BOARD_SIZE * BOARD_SIZE &&
+                        (mask & cellBit(origin + BOARD_SIZE)) != 0;
+        std::uint8_t placement = static_cast<std::uint8_t>(origin | (vertical ? 0x40 : 0));
+        fleets[side].push_back(static_cast<std::uint16_t>(static_cast<unsigned char>(ship.getType()) << 8 | placement));
+    }
+}
+
+// Records a shot; shots that changed nothing (invalid or repeated) are not part of the game
+void GameRecord::addShot(int side, int x, int y, const ShotResult &result)
+{
+    if (result.outcome != SHOT_MISS && result.outcome != SHOT_HIT && result.outcome != SHOT_SUNK)
+        return;
+    if (shots.full())
+        return;
+    bool hit = result.outcome != SHOT_MISS;
+    shots.push_back(static_cast<std::uint8_t>(cellIndex(x, y) | (side << 6) | (hit ? 0x80 : 0)));
+}
+
+void GameRecord::finish(int winningSide)
+{
+    winner = winningSide;
+}
+
+int GameRecord::encodedSize() const
+{
+    return RECORD_HEADER_BYTES + 2 * static_cast<int>(fleets[0].size() + fleets[1].size()) + static_cast<int>(shots.size());
+}
+
+// Writes the record in the layout described in record.h
+int GameRecord::encode(unsigned char *out) const
+{
+    unsigned char *p = out;
+    for (int i = 0; i < 8; i++)
+        *p++ = static_cast<unsigned char>(seed >> (8 * i));
+    *p++ = static_cast<unsigned char>((players[0] & 0x0f) | (players[1] & 0x0f) << 4);
+    *p++ = winner < 0 ? NO_WINNER : static_cast<unsigned char>(winner);
+    *p++ = static_cast<unsigned char>(fleets[0].size() | fleets[1].size() << 4);
+    *p++ = static_cast<unsigned char>(shots.size());
+    for (const auto &fleet : fleets)
+    {
+        for (std::uint16_t ship : fleet)
+        {
+            *p++ = static_cast<unsigned char>(ship >> 8);
+            *p++ = static_cast<unsigned char>(ship);
+        }
+    }
+    for (std::uint8_t shot : shots)
+        *p++ = shot;
+    return static_cast<int>(p - out);
+}
+
+// RecordView implementation
+std::uint64_t RecordView::getSeed() const
+{
+    std::uint64_t seed = 0;
+    for (int i = 0; i < 8; i++)
+        seed |= static_cast<std::uint64_t>(data[i]) << (8 * i);
+    return seed;
+}
+
+int RecordView::getWinner() const
+{
+    return data[9] == NO_WINNER ? -1 : data[9];
+}
+
+RecordedShip RecordView::getShip(int side, int index) const
+{
+    const unsigned char *entry = data + RECORD_HEADER_BYTES + 2 * ((side == 0 ? 0 : getShipCount(0)) + index);
+    RecordedShip ship;
+    ship.type = static_cast<char>(entry[0]);
+    ship.length = shipLengthOf(ship.type);
+    ship.origin = Position((entry[1] & 0x3f) % BOARD_SIZE, (entry[1] & 0x3f) / BOARD_SIZE);
+    ship.vertical = (entry[1] & 0x40) != 0;
+    return ship;
+}
+
+// Gets the mask of all cells covered by a side's fleet
+Bitboard RecordView::getFleetCells(int side) const
+{
+    Bitboard cells = 0;
+    for (int i = 0; i < getShipCount(side); i++)
+    {
+        RecordedShip ship = getShip(side, i);
+        int index = placementIndex(ship.origin.x, ship.origin.y, ship.length, ship.vertical);
+        if (index >= 0)
+            cells |= PLACEMENTS[index].mask;
+    }
+    return cells;
+}
+
+// RecordWriter implementation
+RecordWriter::RecordWriter() : file(nullptr), failed(false)
+{
+    buffer.reserve(BUFFER_BYTES);
+}
+
+RecordWriter::~RecordWriter()
+{
+    close();
+}
+
+// Opens path for appending; a new or empty file gets the file header first. The reader stops at the
+// first truncated record, so one left by a crash is cut off here, or every game appended after it
+// would be unreadable.
+bool RecordWriter::open(const std::string &path)
+{
+    close();
+    std::error_code error;
+    std::uintmax_t size = std::filesystem::exists(path, error) ? std::filesystem::file_size(path, error) : 0;
+    if (error)
+        return false;
+    if (size > 0)
+    {
+        RecordReader reader;
+        if (!reader.open(path))
+            return false;
+        std::uintmax_t whole = RECORD_FILE_HEADER_BYTES;
+        for (RecordView game : reader)
+            whole += static_cast<std::uintmax_t>(game.size());
+        reader.close();
+        if (whole < size)
+        {
+            std::filesystem::resize_file(path, whole, error);
+            if (error)
+                return false;
+        }
+    }
+
+    file = std::fopen(path.c_str(), "ab");
+    if (!file)
+        return false;
+    failed = false;
+    if (size == 0)
+    {
+        unsigned char header[RECORD_FILE_HEADER_BYTES];
+        makeFileHeader(header);
+        buffer.insert(buffer.end(), header, header + RECORD_FILE_HEADER_BYTES);
+    }
+    return true;
+}
+
+// Encodes the record into the buffer, writing the buffer out whenever it fills up
+void RecordWriter::write(const GameRecord &record)
+{
+    unsigned char bytes[MAX_RECORD_BYTES];
+    int size = record.encode(bytes);
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (!file)
+        return;
+    if (buffer.size() + size > BUFFER_BYTES && !flushBuffer())
+        failed = true;
+    buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+bool RecordWriter::flushBuffer()
+{
+    bool ok = buffer.empty() || std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    buffer.clear();
+    return ok;
+}
+
+// Writes out what is buffered and closes the file; false if this or any earlier write failed
+bool RecordWriter::close()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (!file)
+        return !failed;
+    bool ok = flushBuffer() && !failed;
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    failed = !ok;
+    return ok;
+}
+
+// RecordReader implementation
+RecordReader::RecordReader() : data(nullptr), length(0)
+{
+#ifdef _WIN32
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#endif
+}
+
+RecordReader::~RecordReader()
+{
+    close();
+}
+
+// Maps the whole file read-only and checks its header
+bool RecordReader::open(const std::string &path)
+{
+    close();
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart < RECORD_FILE_HEADER_BYTES)
+    {
+        CloseHandle(handle);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(handle);
+        return false;
+    }
+    fileHandle = handle;
+    mappingHandle = mapping;
+    data = static_cast<const unsigned char *>(view);
+    length = static_cast<std::size_t>(size.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < RECORD_FILE_HEADER_BYTES)
+    {
+        ::close(fd);
+        return false;
+    }
+    void *view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping stays valid without the descriptor
+    if (view == MAP_FAILED)
+        return false;
+    madvise(view, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+    data = static_cast<const unsigned char *>(view);
+    length = static_cast<std::size_t>(info.st_size);
+#endif
+
+    if (!isFileHeader(data))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void RecordReader::close()
+{
+    if (!data)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+    CloseHandle(static_cast<HANDLE>(fileHandle));
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#else
+    munmap(const_cast<unsigned char *>(data), length);
+#endif
+    data = nullptr;
+    length = 0;
+}
+
+RecordReader::iterator::iterator(const unsigned char *position, const unsigned char *end) : current(position), last(end)
+{
+    // A record that does not fit in the rest of the file is treated as the end
+    if (current != last && (last - current < RECORD_HEADER_BYTES || last - current < RecordView(current).size()))
+        current = last;
+}
+
+RecordReader::iterator &RecordReader::iterator::operator++()
+{
+    *this = iterator(current + RecordView(current).size(), last);
+    return *this;
+}
+
+RecordReader::iterator RecordReader::begin() const
+{
+    if (!data)
+        return iterator(nullptr, nullptr);
+    return iterator(data + RECORD_FILE_HEADER_BYTES, data + length);
+}
+
+RecordReader::iterator RecordReader::end() const
+{
+    return iterator(data ? data + length : nullptr, data ? data + length : nullptr);
+}
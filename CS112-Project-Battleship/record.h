@@ -0,0 +1,216 @@
+#ifndef RECORD_H
+#define RECORD_H
+
+#include "board.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Binary game records for classic 8x8 games.
+//
+// A record file is an 8-byte file header ("BSGR", version, 3 reserved bytes) followed by
+// game records back to back. One game record is
+//     8 bytes   seed (little endian)
+//     1 byte    players: first side in the low nibble, second side in the high nibble, each a
+//               CpuStrategy or RECORD_INPUT for a side whose moves came from outside
+//     1 byte    winner: 0 or 1 for FIRST_SIDE / SECOND_SIDE, 0xff if the game was abandoned
+//     1 byte    ship counts: first side in the low nibble, second side in the high nibble
+//     1 byte    shot count
+//     2 bytes   per ship, first side's fleet then second side's: type letter, then
+//               top-left cell index (bits 0-5) and a vertical flag (bit 6)
+//     1 byte    per shot in firing order: cell index (bits 0-5), firing side (bit 6), hit (bit 7)
+// so a classic game takes 32 bytes plus one per shot. Ship lengths come from the ship letter
+// (shipLengthOf), and sinks and the game end are recomputed from the fleets when reading.
+
+const int RECORD_VERSION = 2;
+const int RECORD_FILE_HEADER_BYTES = 8;
+const int RECORD_HEADER_BYTES = 12;
+const int RECORD_INPUT = 0x0f; // player code of a human (or scripted) side
+const int MAX_RECORD_SHOTS = 2 * BOARD_SIZE * BOARD_SIZE;
+const int MAX_RECORD_BYTES = RECORD_HEADER_BYTES + 2 * 2 * FLEET_SIZE + MAX_RECORD_SHOTS;
+
+// One ship of a recorded fleet
+struct RecordedShip
+{
+    char type;
+    int length;
+    Position origin; // top-left end
+    bool vertical;
+};
+
+// One recorded shot and what it did
+struct RecordedShot
+{
+    int side; // the side that fired
+    Position target;
+    ShotResult result;
+};
+
+// A game being recorded: the seed, both fleets and every shot that changed the game.
+// It holds no heap memory, so it can be reused for every game a worker plays.
+class GameRecord
+{
+private:
+    std::uint64_t seed;
+    int players[2];
+    int winner;
+    FixedVector<std::uint16_t, FLEET_SIZE> fleets[2]; // encoded ships (type << 8 | placement byte)
+    FixedVector<std::uint8_t, MAX_RECORD_SHOTS> shots;
+
+public:
+    GameRecord();
+
+    // Starts a new game, dropping the previous one; players are CpuStrategy values or RECORD_INPUT
+    void begin(std::uint64_t gameSeed, int firstPlayer, int secondPlayer);
+    void setFleet(int side, const Board &board);  // record the ships placed on a side's board
+    void addShot(int side, int x, int y, const ShotResult &result);
+    void finish(int winningSide);                 // -1 if nobody won
+
+    int encodedSize() const;
+    int encode(unsigned char *out) const; // writes encodedSize() bytes, returns that count
+};
+
+// Read-only view of one encoded game record; it points into the caller's memory and copies nothing
+class RecordView
+{
+private:
+    const unsigned char *data;
+
+public:
+    explicit RecordView(const unsigned char *bytes) : data(bytes) {}
+
+    std::uint64_t getSeed() const;
+    int getPlayer(int side) const { return side == 0 ? (data[8] & 0x0f) : (data[8] >> 4); }
+    int getWinner() const; // -1 if the game was abandoned
+    int getShipCount(int side) const { return side == 0 ? (data[10] & 0x0f) : (data[10] >> 4); }
+    int getShotCount() const { return data[11]; }
+    int size() const { return RECORD_HEADER_BYTES + 2 * (getShipCount(0) + getShipCount(1)) + getShotCount(); }
+
+    RecordedShip getShip(int side, int index) const;
+    Bitboard getFleetCells(int side) const;
+
+    // Calls visit(const RecordedShot &) for every shot in order, with sinks and the game end
+    // recomputed from the fleets
+    template <class Visit>
+    void forEachShot(Visit visit) const;
+};
+
+// Appends game records to a file through a buffer; write() may be called from several threads
+class RecordWriter
+{
+private:
+    static const std::size_t BUFFER_BYTES = 1 << 16;
+
+    std::FILE *file;
+    std::vector<unsigned char> buffer;
+    std::mutex lock;
+    bool failed; // a write since open failed
+
+    bool flushBuffer();
+
+public:
+    RecordWriter();
+    ~RecordWriter();
+    RecordWriter(const RecordWriter &) = delete;
+    RecordWriter &operator=(const RecordWriter &) = delete;
+
+    // Appends to an existing record file, or starts a new one. A record cut short at the end of the
+    // file (a crash mid-write) is dropped first; false if the file exists but is not a record file.
+    bool open(const std::string &path);
+    bool isOpen() const { return file != nullptr; }
+    void write(const GameRecord &record);
+    bool close(); // flushes; false if any write failed
+};
+
+// Memory-maps a record file and iterates its games without copying them
+class RecordReader
+{
+private:
+    const unsigned char *data;
+    std::size_t length;
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#endif
+
+public:
+    RecordReader();
+    ~RecordReader();
+    RecordReader(const RecordReader &) = delete;
+    RecordReader &operator=(const RecordReader &) = delete;
+
+    bool open(const std::string &path); // false if the file is missing or not a record file
+    void close();
+
+    // Forward iterator over the records; a truncated record at the end of the file is skipped
+    class iterator
+    {
+    private:
+        const unsigned char *current;
+        const unsigned char *last;
+
+    public:
+        iterator(const unsigned char *position, const unsigned char *end);
+        RecordView operator*() const { return RecordView(current); }
+        iterator &operator++();
+        bool operator!=(const iterator &other) const { return current != other.current; }
+    };
+
+    iterator begin() const;
+    iterator end() const;
+};
+
+template <class Visit>
+void RecordView::forEachShot(Visit visit) const
+{
+    // Ship masks of both fleets, in the order the ships were recorded
+    Bitboard shipMasks[2][FLEET_SIZE];
+    char shipTypes[2][FLEET_SIZE];
+    for (int side = 0; side < 2; side++)
+    {
+        for (int i = 0; i < getShipCount(side) && i < FLEET_SIZE; i++)
+        {
+            RecordedShip ship = getShip(side, i);
+            int start = placementIndex(ship.origin.x, ship.origin.y, ship.length, ship.vertical);
+            shipMasks[side][i] = start < 0 ? 0 : PLACEMENTS[start].mask;
+            shipTypes[side][i] = ship.type;
+        }
+    }
+    Bitboard fleetCells[2] = {getFleetCells(0), getFleetCells(1)};
+    Bitboard hits[2] = {0, 0}; // hits scored against each side
+
+    const unsigned char *shot = data + RECORD_HEADER_BYTES + 2 * (getShipCount(0) + getShipCount(1));
+    for (int i = 0; i < getShotCount(); i++)
+    {
+        RecordedShot entry;
+        int cell = shot[i] & 0x3f;
+        entry.side = (shot[i] >> 6) & 1;
+        entry.target = Position(cell % BOARD_SIZE, cell / BOARD_SIZE);
+        entry.result.outcome = SHOT_MISS;
+        entry.result.shipType = 0;
+        entry.result.gameOver = false;
+        if (shot[i] & 0x80)
+        {
+            int defender = 1 - entry.side;
+            hits[defender] |= cellBit(cell);
+            entry.result.outcome = SHOT_HIT;
+            for (int s = 0; s < getShipCount(defender) && s < FLEET_SIZE; s++)
+            {
+                if (shipMasks[defender][s] & cellBit(cell))
+                {
+                    entry.result.shipType = shipTypes[defender][s];
+                    if ((shipMasks[defender][s] & ~hits[defender]) == 0)
+                        entry.result.outcome = SHOT_SUNK;
+                    break;
+                }
+            }
+            entry.result.gameOver = (fleetCells[defender] & ~hits[defender]) == 0;
+        }
+        visit(entry);
+    }
+}
+
+#endif
@@ -0,0 +1,260 @@
+#include "render.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <streambuf>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const int TAB_WIDTH = 8;
+    const int MIN_GAP = 6; // unchanged characters shorter than this are rewritten instead of skipped over
+
+    // Passes everything written to std::cout on to its real buffer, counting how many lines it
+    // moved the cursor down: newlines, plus wraps at the terminal width when that is known
+    class LineCountingBuffer : public std::streambuf
+    {
+    private:
+        std::streambuf *target;
+        int lines;
+        int column;
+        int width; // 0 if unknown
+
+        void advance(char c)
+        {
+            if (c == '\n')
+            {
+                lines++;
+                column = 0;
+            }
+            else if (c == '\r')
+            {
+                column = 0;
+            }
+            else if (c == '\t')
+            {
+                column = (column / TAB_WIDTH + 1) * TAB_WIDTH;
+            }
+            else if (++column > width && width > 0)
+            {
+                lines++;
+                column = 1;
+            }
+        }
+
+    protected:
+        int overflow(int c) override
+        {
+            if (c == traits_type::eof())
+                return traits_type::not_eof(c);
+            advance(static_cast<char>(c));
+            return target->sputc(static_cast<char>(c));
+        }
+
+        std::streamsize xsputn(const char *text, std::streamsize count) override
+        {
+            for (std::streamsize i = 0; i < count; i++)
+                advance(text[i]);
+            return target->sputn(text, count);
+        }
+
+        int sync() override { return target->pubsync(); }
+
+    public:
+        explicit LineCountingBuffer(std::streambuf *real) : target(real), lines(0), column(0), width(0) {}
+
+        // Starts counting again from the start of a line, on a terminal terminalWidth columns wide
+        void restart(int terminalWidth)
+        {
+            lines = 0;
+            column = 0;
+            width = terminalWidth;
+        }
+        int linesWritten() const { return lines; }
+    };
+
+    // The counter put in front of std::cout's buffer on first use. It is never destroyed, because
+    // std::cout may still flush through it while the program exits.
+    LineCountingBuffer &coutLines()
+    {
+        static LineCountingBuffer *buffer = nullptr;
+        if (!buffer)
+        {
+            buffer = new LineCountingBuffer(std::cout.rdbuf());
+            std::cout.rdbuf(buffer);
+        }
+        return *buffer;
+    }
+
+    // Rows and columns of the terminal stdout writes to; false if it is not a terminal
+    bool terminalSize(int &rows, int &cols)
+    {
+#ifdef _WIN32
+        CONSOLE_SCREEN_BUFFER_INFO info;
+        if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info))
+            return false;
+        rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+        cols = info.srWindow.Right - info.srWindow.Left + 1;
+#else
+        struct winsize size;
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0)
+            return false;
+        rows = size.ws_row;
+        cols = size.ws_col;
+#endif
+        return rows > 0 && cols > 0;
+    }
+}
+
+FrameRenderer::FrameRenderer()
+    : frontRows(0), backRows(0), backCols(0), screenRows(0), screenCols(0), row(0), col(0), valid(false)
+{
+    std::memset(front, ' ', sizeof(front));
+    std::memset(back, ' ', sizeof(back));
+    output.reserve(ROWS * COLS * 2);
+}
+
+// Starts a new blank frame at the top-left corner
+void FrameRenderer::beginFrame()
+{
+    std::memset(back, ' ', sizeof(back));
+    backRows = 0;
+    backCols = 0;
+    row = 0;
+    col = 0;
+}
+
+// Appends one character at the frame cursor; text beyond the frame size is dropped
+void FrameRenderer::print(char c)
+{
+    if (c == '\n')
+    {
+        row++;
+        col = 0;
+        return;
+    }
+    if (c == '\t')
+    {
+        col = (col / TAB_WIDTH + 1) * TAB_WIDTH;
+        return;
+    }
+    if (row < ROWS && col < COLS)
+    {
+        back[row][col] = c;
+        if (row + 1 > backRows)
+            backRows = row + 1;
+        if (col + 1 > backCols)
+            backCols = col + 1;
+    }
+    col++;
+}
+
+void FrameRenderer::print(const char *text)
+{
+    for (; *text; text++)
+        print(*text);
+}
+
+// Appends an ANSI cursor move to the 0-based cell (r, c)
+void FrameRenderer::moveTo(int r, int c)
+{
+    char move[16];
+    int length = std::snprintf(move, sizeof(move), "\033[%d;%dH", r + 1, c + 1);
+    output.append(move, length);
+}
+
+// Emits the difference between the screen and the composed frame in one write
+void FrameRenderer::present()
+{
+    // The composed frame ends at the cursor line, so blank trailing lines count too
+    if (row + (col > 0 ? 1 : 0) > backRows)
+        backRows = row + (col > 0 ? 1 : 0);
+    if (backRows > ROWS)
+        backRows = ROWS;
+
+    // Output below the frame that reached the bottom line scrolled the frame up, and a resize
+    // may have reflowed it
+    LineCountingBuffer &printed = coutLines();
+    std::cout.flush();
+    int rowsNow = 0, colsNow = 0;
+    bool terminal = terminalSize(rowsNow, colsNow);
+    if (terminal && (rowsNow != screenRows || colsNow != screenCols || frontRows + printed.linesWritten() >= rowsNow))
+        valid = false;
+    screenRows = terminal ? rowsNow : 0;
+    screenCols = terminal ? colsNow : 0;
+
+    output.clear();
+    if (terminal && (backRows >= screenRows || backCols > screenCols))
+    {
+        // The frame plus the cursor line below it does not fit on the screen, so its rows are not
+        // screen rows: print it whole and diff nothing until it fits again
+        output.append("\033[H\033[2J");
+        for (int r = 0; r < backRows; r++)
+        {
+            int end = backCols;
+            while (end > 0 && back[r][end - 1] == ' ')
+                end--;
+            output.append(back[r], end);
+            output.append("\n");
+        }
+        valid = false;
+        std::fwrite(output.data(), 1, output.size(), stdout);
+        std::fflush(stdout);
+        printed.restart(screenCols);
+        return;
+    }
+
+    if (!valid)
+    {
+        // Unknown screen contents: clear it and compare against a blank frame
+        output.append("\033[H\033[2J");
+        std::memset(front, ' ', sizeof(front));
+        frontRows = 0;
+    }
+
+    int rows = backRows > frontRows ? backRows : frontRows;
+    for (int r = 0; r < rows; r++)
+    {
+        int c = 0;
+        while (c < COLS)
+        {
+            if (front[r][c] == back[r][c])
+            {
+                c++;
+                continue;
+            }
+            // Extend the run until MIN_GAP unchanged characters in a row are found
+            int end = c + 1;
+            for (int same = 0; end < COLS && same < MIN_GAP; end++)
+                same = (front[r][end] == back[r][end]) ? same + 1 : 0;
+            moveTo(r, c);
+            output.append(back[r] + c, end - c);
+            c = end;
+        }
+    }
+
+    // Leave the cursor under the frame and wipe whatever older output was printed there
+    moveTo(backRows, 0);
+    output.append("\033[J");
+
+    std::memcpy(front, back, sizeof(front));
+    frontRows = backRows;
+    valid = true;
+
+    std::fwrite(output.data(), 1, output.size(), stdout);
+    std::fflush(stdout);
+    printed.restart(screenCols);
+}
+
+void FrameRenderer::invalidate()
+{
+    valid = false;
+}
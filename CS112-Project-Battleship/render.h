@@ -0,0 +1,49 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <string>
+
+// Frame-buffered terminal renderer.
+// A frame is composed in a preallocated character grid anchored at the top-left of the screen.
+// present() compares it with the frame currently on screen and emits only ANSI cursor moves plus
+// the changed characters, all in a single write. Anything printed after present() appears below
+// the frame. invalidate() forces the next present() to repaint everything, e.g. after the screen
+// was cleared.
+//
+// The cursor moves are absolute, so they only land on the right lines while the frame fits the
+// terminal and has not scrolled. present() therefore checks the window size each time and
+// repaints the whole frame as plain text when it does not fit. It also counts the lines written
+// to std::cout since the last present(), and repaints everything when that output reached the
+// bottom of the screen and scrolled the frame, or when the window was resized. When stdout is
+// not a terminal there is no screen to get wrong, so the frame is always diffed.
+class FrameRenderer
+{
+public:
+    static const int ROWS = 40;
+    static const int COLS = 200;
+
+    FrameRenderer();
+
+    void beginFrame();             // start composing a new, blank frame
+    void print(const char *text);  // append text; handles '\n' and '\t' like a terminal
+    void print(char c);
+    void present();                // bring the screen up to date with the composed frame
+    void invalidate();             // the screen no longer shows the last presented frame
+
+private:
+    char front[ROWS][COLS]; // what the screen shows
+    char back[ROWS][COLS];  // the frame being composed
+    int frontRows;
+    int backRows;
+    int backCols;    // columns the composed frame uses
+    int screenRows;  // terminal size at the last present(), 0 if unknown
+    int screenCols;
+    int row;
+    int col;
+    bool valid;
+    std::string output; // escape sequences for one present(), capacity reserved once
+
+    void moveTo(int r, int c);
+};
+
+#endif
@@ -0,0 +1,161 @@
+#include "replay.h"
+#include "engine.h"
+#include "ai.h"
+
+#include <memory>
+#include <sstream>
+
+namespace
+{
+    const char *SIDE_NAMES[2] = {"first", "second"};
+
+    // Name of a recorded player code
+    std::string playerName(int player)
+    {
+        if (player == RECORD_INPUT)
+            return "input";
+        return cpuStrategyName(static_cast<CpuStrategy>(player));
+    }
+
+    // Coordinate in the game's notation, e.g. C4
+    std::string coordinate(const Position &p)
+    {
+        return std::string(1, static_cast<char>('A' + p.y)) + std::to_string(p.x + 1);
+    }
+
+    const char *outcomeName(ShotOutcome outcome)
+    {
+        switch (outcome)
+        {
+        case SHOT_MISS:
+            return "miss";
+        case SHOT_HIT:
+            return "hit";
+        case SHOT_SUNK:
+            return "sunk";
+        case SHOT_ALREADY_TAKEN:
+            return "already taken";
+        default:
+            return "invalid";
+        }
+    }
+
+    // Mask covered by a recorded ship, 0 if it does not fit on the board
+    Bitboard recordedMask(const RecordedShip &ship)
+    {
+        int index = placementIndex(ship.origin.x, ship.origin.y, ship.length, ship.vertical);
+        return index < 0 ? 0 : PLACEMENTS[index].mask;
+    }
+}
+
+// Places each side's fleet as the game did, runs the shots in order and stops at the first difference
+bool replayGame(const RecordView &game, std::string &difference)
+{
+    GameEngine engine("First", "Second");
+    engine.reset();
+    Rng rngs[2];
+    std::unique_ptr<TargetingStrategy> ai[2];
+
+    for (int side = 0; side < 2; side++)
+    {
+        rngs[side].reseed(deriveSeed(game.getSeed(), side));
+        Board &board = engine.getPlayer(side).getOwnBoard();
+        int player = game.getPlayer(side);
+        if (player != RECORD_INPUT)
+        {
+            // A CPU side deals its own fleet, then targets with its strategy
+            ai[side] = makeTargetingStrategy(static_cast<CpuStrategy>(player));
+            board.placeRandomShips(side == SECOND_SIDE, rngs[side]);
+        }
+        else
+        {
+            for (int i = 0; i < game.getShipCount(side); i++)
+            {
+                RecordedShip recorded = game.getShip(side, i);
+                Ship ship(recorded.type, recorded.length);
+                board.placeShip(ship, recorded.origin.x, recorded.origin.y, recorded.vertical ? DOWN : RIGHT);
+            }
+        }
+
+        bool same = static_cast<int>(board.getShips().size()) == game.getShipCount(side);
+        for (int i = 0; same && i < game.getShipCount(side); i++)
+        {
+            RecordedShip recorded = game.getShip(side, i);
+            same = board.getShips()[i].getType() == recorded.type && board.getShips()[i].getMask() == recordedMask(recorded);
+        }
+        if (!same)
+        {
+            difference = std::string("the ") + SIDE_NAMES[side] + " side's fleet differs from the record";
+            return false;
+        }
+    }
+
+    bool failed = false;
+    int number = 0;
+    game.forEachShot([&](const RecordedShot &shot)
+                     {
+        number++;
+        if (failed)
+            return;
+        const Board &tracking = engine.getPlayer(shot.side).getTrackingBoard();
+        Position target = shot.target;
+        if (ai[shot.side])
+            target = ai[shot.side]->chooseTarget(tracking, rngs[shot.side]);
+
+        ShotResult result = engine.fire(shot.side, target.x, target.y);
+        if (ai[shot.side])
+            ai[shot.side]->recordResult(tracking, target, result);
+
+        if (!(target == shot.target) || result.outcome != shot.result.outcome || result.gameOver != shot.result.gameOver)
+        {
+            std::ostringstream message;
+            message << "shot " << number << ": the " << SIDE_NAMES[shot.side] << " side fired at " << coordinate(target)
+                    << " (" << outcomeName(result.outcome) << "), the record has " << coordinate(shot.target)
+                    << " (" << outcomeName(shot.result.outcome) << ")";
+            difference = message.str();
+            failed = true;
+        } });
+    if (failed)
+    {
+        return false;
+    }
+
+    if (engine.getWinner() != game.getWinner())
+    {
+        difference = "the replay ends with a different winner";
+        return false;
+    }
+    return true;
+}
+
+// Prints the header, both fleets and every shot of a game
+void printGame(const RecordView &game, std::ostream &out)
+{
+    out << "Game seed " << game.getSeed() << ": " << playerName(game.getPlayer(0)) << " vs " << playerName(game.getPlayer(1));
+    if (game.getWinner() < 0)
+        out << ", unfinished\n";
+    else
+        out << ", won by the " << SIDE_NAMES[game.getWinner()] << " side\n";
+
+    for (int side = 0; side < 2; side++)
+    {
+        out << "  " << SIDE_NAMES[side] << " fleet:";
+        for (int i = 0; i < game.getShipCount(side); i++)
+        {
+            RecordedShip ship = game.getShip(side, i);
+            out << " " << ship.type << "@" << coordinate(ship.origin) << (ship.vertical ? "v" : ">");
+        }
+        out << "\n";
+    }
+
+    int number = 0;
+    game.forEachShot([&](const RecordedShot &shot)
+                     {
+        out << "  " << ++number << ". " << SIDE_NAMES[shot.side] << " " << coordinate(shot.target) << " "
+            << outcomeName(shot.result.outcome);
+        if (shot.result.outcome == SHOT_SUNK)
+            out << " " << shot.result.shipType;
+        if (shot.result.gameOver)
+            out << ", game over";
+        out << "\n"; });
+}
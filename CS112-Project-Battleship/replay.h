@@ -0,0 +1,20 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+#include "record.h"
+#include <ostream>
+#include <string>
+
+// Deterministic replay of recorded games.
+// Every game is driven by its seed: side s makes all of its random decisions (random fleet
+// placement and CPU targeting) with Rng(deriveSeed(seed, s)). A CPU side is therefore re-executed
+// from the seed and its strategy alone, while a human or scripted side (RECORD_INPUT) takes its
+// fleet and shots from the record.
+
+// Re-executes game and compares every fleet, shot and result with the record.
+// Returns true if the replay matched; otherwise difference describes the first mismatch.
+bool replayGame(const RecordView &game, std::string &difference);
+
+// Prints a game move by move: players, seed, fleets, then each shot and what it did
+void printGame(const RecordView &game, std::ostream &out);
+
+#endif
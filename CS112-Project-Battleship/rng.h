@@ -0,0 +1,121 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+// xoshiro256** pseudo-random generator (Blackman & Vigna).
+// Small, fast and owned per board/worker/game, so nothing shares hidden global state the way
+// rand() does. Satisfies UniformRandomBitGenerator, so it also works with <random> distributions.
+class Rng
+{
+private:
+    std::uint64_t state[4];
+
+    static std::uint64_t rotl(std::uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    typedef std::uint64_t result_type;
+
+    // Expands a 64-bit seed into the full state with splitmix64
+    explicit Rng(std::uint64_t seed = 0)
+    {
+        reseed(seed);
+    }
+
+    void reseed(std::uint64_t seed)
+    {
+        for (auto &word : state)
+        {
+            seed += 0x9e3779b97f4a7c15ULL;
+            std::uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+
+    result_type operator()()
+    {
+        std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+        std::uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Uniform integer in [0, bound) using Lemire's multiply-shift reduction (bound > 0, below 2^32)
+    std::uint32_t below(std::uint32_t bound)
+    {
+        return static_cast<std::uint32_t>(((*this)() >> 32) * bound >> 32);
+    }
+
+    // Advances the generator by 2^128 steps; successive jumps give non-overlapping streams for workers
+    void jump()
+    {
+        static const std::uint64_t JUMP[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                             0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+        std::uint64_t s[4] = {0, 0, 0, 0};
+        for (std::uint64_t word : JUMP)
+        {
+            for (int bit = 0; bit < 64; bit++)
+            {
+                if (word & (std::uint64_t(1) << bit))
+                {
+                    for (int i = 0; i < 4; i++)
+                        s[i] ^= state[i];
+                }
+                (*this)();
+            }
+        }
+        for (int i = 0; i < 4; i++)
+            state[i] = s[i];
+    }
+};
+
+// The index-th seed derived from base (a splitmix64 step), for independent generators:
+// game i of a run is played from deriveSeed(runSeed, i), and side s of a game draws from
+// Rng(deriveSeed(gameSeed, s)), so every game can be replayed from its own seed.
+constexpr std::uint64_t deriveSeed(std::uint64_t base, std::uint64_t index)
+{
+    std::uint64_t z = base + (index + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Markers a cell can hold in a Zobrist hash
+enum ZobristMarker
+{
+    ZOBRIST_HIT,
+    ZOBRIST_MISS,
+    ZOBRIST_SUNK, // a hit attributed to a sunk ship (kept by strategies, not by boards)
+    ZOBRIST_MARKERS
+};
+
+// Fixed pseudo-random key of a marker on a cell. A position's Zobrist hash is the XOR of the keys
+// of its markers, so setting or clearing one marker updates the hash with a single XOR.
+constexpr std::uint64_t zobristKey(std::uint64_t cell, ZobristMarker marker)
+{
+    return deriveSeed(0x5a0b7157ULL, cell * ZOBRIST_MARKERS + marker);
+}
+
+// A seed for sessions that do not ask for a specific one
+inline std::uint64_t freshSeed()
+{
+    std::uint64_t clock = static_cast<std::uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    return clock ^ (static_cast<std::uint64_t>(std::random_device{}()) << 32);
+}
+
+#endif
@@ -0,0 +1,278 @@
+#include "script.h"
+#include "engine.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+
+namespace
+{
+    // Strips a '#' comment and splits the rest of a line into words
+    std::vector<std::string> splitLine(const std::string &line)
+    {
+        std::istringstream words(line.substr(0, line.find('#')));
+        std::vector<std::string> tokens;
+        std::string token;
+        while (words >> token)
+            tokens.push_back(token);
+        return tokens;
+    }
+
+    std::string lineError(int line, const std::string &message)
+    {
+        return "line " + std::to_string(line) + ": " + message;
+    }
+
+    bool isPlayerShip(char type)
+    {
+        for (const auto &def : PLAYER_FLEET)
+        {
+            if (def.type == type)
+                return true;
+        }
+        return false;
+    }
+
+    // Places the scripted fleet on board; returns false and sets error if a ship does not fit
+    bool placeFleet(const ScriptedGame &game, Board &board, Rng &rng, std::string &error)
+    {
+        if (game.randomFleet)
+        {
+            board.placeRandomShips(false, rng);
+            return true;
+        }
+        for (const auto &placed : game.fleet)
+        {
+            int length = shipLengthOf(placed.type);
+            if (!board.isValidPlacement(placed.start.x, placed.start.y, length, placed.dir))
+            {
+                error = lineError(placed.line, std::string("ship ") + placed.type + " overlaps another ship or leaves the board");
+                return false;
+            }
+            Ship ship(placed.type, length);
+            board.placeShip(ship, placed.start.x, placed.start.y, placed.dir);
+        }
+        return true;
+    }
+}
+
+// ScriptReader implementation
+ScriptReader::ScriptReader(std::istream &input) : in(input), lineNumber(0) {}
+
+// Reads up to and including the end of the current game
+bool ScriptReader::skipGame()
+{
+    std::string line;
+    while (std::getline(in, line))
+    {
+        lineNumber++;
+        std::vector<std::string> tokens = splitLine(line);
+        if (!tokens.empty() && tokens[0] == "end")
+            return true;
+    }
+    return false;
+}
+
+// Reads the next game; every directive is checked here so that runScript only sees well-formed games
+bool ScriptReader::next(ScriptedGame &game, std::string &error)
+{
+    error.clear();
+    game.line = 0;
+    game.hasSeed = false;
+    game.seed = 0;
+    game.hasCpu = false;
+    game.cpu = CPU_HUNT;
+    game.randomFleet = false;
+    game.fleet.clear();
+    game.shots.clear();
+
+    std::string line;
+    while (std::getline(in, line))
+    {
+        lineNumber++;
+        std::vector<std::string> tokens = splitLine(line);
+        if (tokens.empty())
+            continue;
+        const std::string &directive = tokens[0];
+
+        if (game.line == 0)
+        {
+            // Between games only a new game may start
+            game.line = lineNumber;
+            if (directive != "game" || tokens.size() > 2)
+                error = lineError(lineNumber, "expected 'game [SEED]', found '" + directive + "'");
+            else if (tokens.size() == 2)
+            {
+                char *end = nullptr;
+                game.seed = std::strtoull(tokens[1].c_str(), &end, 10);
+                game.hasSeed = *end == '\0' && tokens[1][0] != '-';
+                if (!game.hasSeed)
+                    error = lineError(lineNumber, "bad seed '" + tokens[1] + "'");
+            }
+        }
+        else if (directive == "end" && tokens.size() == 1)
+        {
+            if (!game.randomFleet && static_cast<int>(game.fleet.size()) != FLEET_SIZE)
+                error = lineError(lineNumber, "the fleet needs all " + std::to_string(FLEET_SIZE) + " ships or 'random'");
+            return true;
+        }
+        else if (directive == "cpu" && tokens.size() == 2)
+        {
+            game.hasCpu = parseCpuStrategy(tokens[1], game.cpu);
+            if (!game.hasCpu)
+                error = lineError(lineNumber, "unknown CPU strategy '" + tokens[1] + "'");
+        }
+        else if (directive == "random" && tokens.size() == 1)
+        {
+            if (!game.fleet.empty())
+                error = lineError(lineNumber, "'random' after ships were placed");
+            game.randomFleet = true;
+        }
+        else if (directive == "place" && tokens.size() == 4)
+        {
+            ScriptedShip ship;
+            ship.line = lineNumber;
+            ship.type = static_cast<char>(toupper(static_cast<unsigned char>(tokens[1][0])));
+            bool known = tokens[1].size() == 1 && isPlayerShip(ship.type);
+            bool repeated = false;
+            for (const auto &placed : game.fleet)
+                repeated = repeated || placed.type == ship.type;
+
+            if (game.randomFleet)
+                error = lineError(lineNumber, "'place' after 'random'");
+            else if (!known)
+                error = lineError(lineNumber, "unknown ship '" + tokens[1] + "'");
+            else if (repeated)
+                error = lineError(lineNumber, "ship " + tokens[1] + " placed twice");
+            else if (parseCoordinate(tokens[2], ship.start) != COORD_OK)
+                error = lineError(lineNumber, "bad position '" + tokens[2] + "'");
+            else if (!parseDirection(tokens[3], ship.dir))
+                error = lineError(lineNumber, "bad direction '" + tokens[3] + "'");
+            else
+                game.fleet.push_back(ship);
+        }
+        else if (directive == "fire")
+        {
+            for (size_t i = 1; i < tokens.size() && error.empty(); i++)
+            {
+                Position target;
+                if (parseCoordinate(tokens[i], target) == COORD_OK)
+                    game.shots.push_back(target);
+                else
+                    error = lineError(lineNumber, "bad target '" + tokens[i] + "'");
+            }
+        }
+        else
+        {
+            error = lineError(lineNumber, "unknown directive '" + line + "'");
+        }
+
+        if (!error.empty())
+        {
+            if (directive != "end")
+                skipGame();
+            return true;
+        }
+    }
+
+    if (game.line != 0)
+    {
+        error = lineError(game.line, "game without 'end'");
+        return true;
+    }
+    return false;
+}
+
+// Plays the games of a script one after another on a single engine
+ScriptSummary runScript(std::istream &in, const ScriptConfig &config, std::ostream &out)
+{
+    ScriptSummary summary = {0, 0, 0, 0, 0};
+    ScriptReader reader(in);
+    GameEngine engine("Player", "CPU");
+    GameRecord record;
+    Rng sideRng[2];
+    std::unique_ptr<TargetingStrategy> strategies[CPU_STRATEGY_COUNT];
+
+    ScriptedGame game;
+    std::string error;
+    for (unsigned int index = 0; reader.next(game, error); index++)
+    {
+        if (!error.empty())
+        {
+            summary.errors++;
+            out << "game " << index + 1 << ": " << error << "\n";
+            continue;
+        }
+
+        std::uint64_t seed = game.hasSeed ? game.seed : deriveSeed(config.seed, index);
+        CpuStrategy strategy = game.hasCpu ? game.cpu : config.cpuStrategy;
+        if (!strategies[strategy])
+            strategies[strategy] = makeTargetingStrategy(strategy);
+        TargetingStrategy &cpuAi = *strategies[strategy];
+
+        // Same order of random draws as Game::initialize, so the seed reproduces a console game
+        engine.reset();
+        cpuAi.reset();
+        sideRng[FIRST_SIDE].reseed(deriveSeed(seed, FIRST_SIDE));
+        sideRng[SECOND_SIDE].reseed(deriveSeed(seed, SECOND_SIDE));
+        record.begin(seed, RECORD_INPUT, strategy);
+        engine.setRecord(config.recorder ? &record : nullptr);
+        engine.getPlayer(SECOND_SIDE).getOwnBoard().placeRandomShips(true, sideRng[SECOND_SIDE]);
+        if (!placeFleet(game, engine.getPlayer(FIRST_SIDE).getOwnBoard(), sideRng[FIRST_SIDE], error))
+        {
+            summary.errors++;
+            out << "game " << index + 1 << ": " << error << "\n";
+            continue;
+        }
+
+        size_t nextShot = 0;
+        const Board &tracking = engine.getPlayer(SECOND_SIDE).getTrackingBoard();
+        while (!engine.isGameOver())
+        {
+            if (engine.getCurrentSide() == FIRST_SIDE)
+            {
+                if (nextShot == game.shots.size())
+                    break; // the script ran out of shots
+                const Position &target = game.shots[nextShot++];
+                engine.step(target.x, target.y);
+            }
+            else
+            {
+                Position target = cpuAi.chooseTarget(tracking, sideRng[SECOND_SIDE]);
+                ShotResult result = engine.step(target.x, target.y);
+                cpuAi.recordResult(tracking, target, result);
+                if (result.outcome == SHOT_INVALID || result.outcome == SHOT_ALREADY_TAKEN)
+                    engine.forfeit(); // the strategy picked a cell it cannot fire at; retrying would never end its turn
+            }
+        }
+
+        int winner = engine.getWinner();
+        summary.games++;
+        out << "game " << index + 1 << " (seed " << seed << "): ";
+        if (winner == FIRST_SIDE)
+        {
+            summary.playerWins++;
+            out << "player wins in " << engine.getShotsFired(FIRST_SIDE) << " shots\n";
+        }
+        else if (winner == SECOND_SIDE)
+        {
+            summary.cpuWins++;
+            out << "cpu wins in " << engine.getShotsFired(SECOND_SIDE) << " shots\n";
+        }
+        else
+        {
+            summary.unfinished++;
+            out << "unfinished after " << engine.getShotsFired(FIRST_SIDE) << " player shots\n";
+        }
+
+        if (config.recorder)
+        {
+            record.setFleet(FIRST_SIDE, engine.getPlayer(FIRST_SIDE).getOwnBoard());
+            record.setFleet(SECOND_SIDE, engine.getPlayer(SECOND_SIDE).getOwnBoard());
+            record.finish(winner);
+            config.recorder->write(record);
+        }
+    }
+    return summary;
+}
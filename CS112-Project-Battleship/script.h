@@ -0,0 +1,86 @@
+#ifndef SCRIPT_H
+#define SCRIPT_H
+#include "ai.h"
+#include "record.h"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Scripted games: the player's fleet and shots come from a file or pipe instead of the prompts,
+// and games are played back to back against the CPU with no delays or screen output.
+//
+// A script is a list of games, one directive per line; '#' starts a comment:
+//     game [SEED]          starts a game; without SEED the seed is derived from the run seed
+//     cpu random|smart|expert|exact|sampling|anytime
+//                          CPU strategy for this game (default: the run's strategy)
+//     place T C4 right     places one of the player's ships (T, Z, H, Y, M) from a start cell in a
+//                          direction (left, right, up, down or L, R, U, D)
+//     random               places the player's fleet randomly instead
+//     fire A1 A2 ...       the player's next shots, in order; any number per line
+//     end                  ends the game
+// The game runs exactly like the console game with the same seed: the CPU places its fleet and
+// targets with its own generator, and the player fires the scripted shots in turn. Shots at cells
+// already fired at are skipped, as the prompt would ask again. A game whose shots run out before
+// it is decided ends unfinished.
+
+// One of the player's ships as the script places it
+struct ScriptedShip
+{
+    char type;
+    Position start;
+    Direction dir;
+    int line; // line of the place directive
+};
+
+// A game as read from the script
+struct ScriptedGame
+{
+    int line;                 // line of the game directive
+    bool hasSeed;             // seed was given in the script
+    std::uint64_t seed;
+    bool hasCpu;              // cpu was given in the script
+    CpuStrategy cpu;
+    bool randomFleet;
+    std::vector<ScriptedShip> fleet;
+    std::vector<Position> shots;
+};
+
+// Reads games one at a time from a script; parsing never throws
+class ScriptReader
+{
+private:
+    std::istream &in;
+    int lineNumber;
+
+    bool skipGame(); // discards the rest of a malformed game
+
+public:
+    explicit ScriptReader(std::istream &input);
+
+    // Reads the next game into game; returns false at the end of the script.
+    // A malformed game is skipped and reported in error ("line N: ..."), which is empty otherwise.
+    bool next(ScriptedGame &game, std::string &error);
+};
+
+struct ScriptConfig
+{
+    unsigned long long seed; // run seed; game i without its own seed is played from deriveSeed(seed, i)
+    CpuStrategy cpuStrategy; // strategy of games without a cpu line
+    RecordWriter *recorder;  // receives a record of every game played, if set
+};
+
+struct ScriptSummary
+{
+    unsigned int games; // games played, not counting malformed ones
+    unsigned int playerWins;
+    unsigned int cpuWins;
+    unsigned int unfinished;
+    unsigned int errors; // malformed games
+};
+
+// Plays every game of the script and prints one line per game to out
+ScriptSummary runScript(std::istream &in, const ScriptConfig &config, std::ostream &out);
+
+#endif
@@ -0,0 +1,354 @@
+#ifndef SPARSE_BOARD_H
+#define SPARSE_BOARD_H
+
+#include "board.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// A ship on a SparseBoard: a Ship without the cell mask, which would be as large as the ocean
+template <int MaxLength = MAX_SHIP_LENGTH>
+class SparseShip
+{
+private:
+    char type;
+    int length;
+    int hitsRemaining;
+    FixedVector<Position, MaxLength> positions;
+
+public:
+    SparseShip() : type(' '), length(0), hitsRemaining(0) {}
+    SparseShip(char shipType, int shipLength) : type(shipType), length(shipLength), hitsRemaining(shipLength) {}
+
+    char getType() const { return type; }
+    int getLength() const { return length; }
+    int getHitsRemaining() const { return hitsRemaining; }
+
+    bool isDestroyed() const { return hitsRemaining <= 0; }
+    void hit()
+    {
+        if (hitsRemaining > 0)
+            hitsRemaining--;
+    }
+    void addPosition(const Position &pos)
+    {
+        if (!positions.full())
+            positions.push_back(pos);
+    }
+    const FixedVector<Position, MaxLength> &getPositions() const { return positions; }
+};
+
+// Board backend for very large oceans (millions of cells, hundreds of ships).
+// Only cells that hold a ship or have been fired at are stored, in one hash map keyed by cell
+// index, so memory grows with the number of ships and shots instead of with Width * Height.
+// It answers the same queries as BasicBoard apart from the cell masks, so BasicPlayer and
+// BasicGameEngine accept it in place of a dense board.
+template <int Width, int Height, int MaxShipLength = MAX_SHIP_LENGTH>
+class SparseBoard
+{
+public:
+    static constexpr int WIDTH = Width;
+    static constexpr int HEIGHT = Height;
+    static constexpr std::int64_t CELLS = std::int64_t(Width) * Height;
+    typedef SparseShip<MaxShipLength> ShipType;
+
+    static_assert(CELLS < (std::int64_t(1) << 32), "random placement draws 32-bit indices");
+
+private:
+    // What is known about one stored cell; cells that are neither are not stored at all
+    struct CellState
+    {
+        std::int32_t ship; // index into ships, -1 for water
+        char shot;         // HIT_CHAR, MISS_CHAR or 0 if not fired at
+    };
+
+    static const int MAX_PLACEMENT_ATTEMPTS = 10000; // random draws per ship before the ocean counts as full
+
+    std::unordered_map<std::uint64_t, CellState> cells;
+    std::vector<ShipType> ships;
+    std::int64_t shipCellCount; // cells occupied by any ship
+    std::int64_t hitShipCount;  // ship cells marked as hit
+    std::uint64_t stateHash;    // Zobrist hash of the hit and miss markers
+
+    static std::uint64_t key(int x, int y) { return std::uint64_t(y) * Width + x; }
+    // Zobrist key of a shot marker at (x, y), 0 for no shot
+    static std::uint64_t shotKey(int x, int y, char shot)
+    {
+        return shot ? zobristKey(key(x, y), shot == HIT_CHAR ? ZOBRIST_HIT : ZOBRIST_MISS) : 0;
+    }
+    const CellState *find(int x, int y) const;
+    static bool normalise(int &x, int &y, int length, Direction dir, bool &vertical);
+    void markShot(int x, int y, char shot);
+
+public:
+    SparseBoard() : shipCellCount(0), hitShipCount(0), stateHash(0) {}
+
+    // True if (x, y) lies on the board
+    static bool contains(int x, int y) { return x >= 0 && x < Width && y >= 0 && y < Height; }
+
+    void clearBoard();
+    char getCell(int x, int y) const;
+    void setCell(int x, int y, char value);
+    bool isEmptyCell(int x, int y) const;
+    bool isValidPlacement(int x, int y, int length, Direction dir) const;
+    void placeShip(ShipType &ship, int x, int y, Direction dir);
+    void placeRandomShips(const Fleet &fleet, Rng &rng);
+    ShotResult processShot(int x, int y);
+    bool allShipsDestroyed() const { return !ships.empty() && hitShipCount == shipCellCount; }
+    bool isShipDestroyed(char shipType) const;
+    const std::vector<ShipType> &getShips() const { return ships; }
+
+    // Number of cells held in memory, i.e. ship cells plus shots in open water
+    std::size_t storedCells() const { return cells.size(); }
+    // Zobrist hash of the shots on the board, as BasicBoard::getStateHash
+    std::uint64_t getStateHash() const { return stateHash; }
+};
+
+// Clears the board, emptying every cell and removing all ships.
+template <int Width, int Height, int MaxShipLength>
+void SparseBoard<Width, Height, MaxShipLength>::clearBoard()
+{
+    cells.clear();
+    ships.clear();
+    shipCellCount = 0;
+    hitShipCount = 0;
+    stateHash = 0;
+}
+
+// Returns the stored state of (x, y), or nullptr for untouched water
+template <int Width, int Height, int MaxShipLength>
+const typename SparseBoard<Width, Height, MaxShipLength>::CellState *
+SparseBoard<Width, Height, MaxShipLength>::find(int x, int y) const
+{
+    auto it = cells.find(key(x, y));
+    return it == cells.end() ? nullptr : &it->second;
+}
+
+// Gets the character at a specific cell: shot markers first, then the ship type.
+template <int Width, int Height, int MaxShipLength>
+char SparseBoard<Width, Height, MaxShipLength>::getCell(int x, int y) const
+{
+    if (!contains(x, y))
+    {
+        return ' ';
+    }
+    const CellState *state = find(x, y);
+    if (!state)
+        return EMPTY_CHAR;
+    if (state->shot)
+        return state->shot;
+    return state->ship >= 0 ? ships[state->ship].getType() : EMPTY_CHAR;
+}
+
+// Sets the shot marker of a cell, keeping the hit count of ship cells in step
+template <int Width, int Height, int MaxShipLength>
+void SparseBoard<Width, Height, MaxShipLength>::markShot(int x, int y, char shot)
+{
+    auto it = cells.find(key(x, y));
+    if (it == cells.end())
+    {
+        if (shot)
+            cells.emplace(key(x, y), CellState{-1, shot});
+        stateHash ^= shotKey(x, y, shot);
+        return;
+    }
+
+    CellState &state = it->second;
+    stateHash ^= shotKey(x, y, state.shot) ^ shotKey(x, y, shot);
+    if (state.ship >= 0)
+        hitShipCount += (shot == HIT_CHAR) - (state.shot == HIT_CHAR);
+    state.shot = shot;
+    if (state.ship < 0 && !shot)
+        cells.erase(it); // back to untouched water
+}
+
+// Sets the character at a specific cell on the board.
+// Only shot markers (HIT_CHAR, MISS_CHAR) and EMPTY_CHAR are stored; ship cells are set by placeShip.
+template <int Width, int Height, int MaxShipLength>
+void SparseBoard<Width, Height, MaxShipLength>::setCell(int x, int y, char value)
+{
+    if (!contains(x, y))
+    {
+        return;
+    }
+    if (value == HIT_CHAR || value == MISS_CHAR)
+        markShot(x, y, value);
+    else if (value == EMPTY_CHAR)
+        markShot(x, y, 0);
+}
+
+// Checks if a specific cell on the board is empty.
+template <int Width, int Height, int MaxShipLength>
+bool SparseBoard<Width, Height, MaxShipLength>::isEmptyCell(int x, int y) const
+{
+    return contains(x, y) && !find(x, y);
+}
+
+// Moves (x, y) to the top-left end of a ship pointing in dir.
+// Returns false if the ship leaves the board or its length is out of range.
+template <int Width, int Height, int MaxShipLength>
+bool SparseBoard<Width, Height, MaxShipLength>::normalise(int &x, int &y, int length, Direction dir, bool &vertical)
+{
+    if (length < 1 || length > MaxShipLength)
+        return false;
+    if (dir == LEFT)
+        x -= length - 1;
+    else if (dir == UP)
+        y -= length - 1;
+    vertical = dir == UP || dir == DOWN;
+    return contains(x, y) && contains(vertical ? x : x + length - 1, vertical ? y + length - 1 : y);
+}
+
+// Checks if a ship placement is valid: on the board and clear of ships and shots.
+template <int Width, int Height, int MaxShipLength>
+bool SparseBoard<Width, Height, MaxShipLength>::isValidPlacement(int x, int y, int length, Direction dir) const
+{
+    bool vertical;
+    if (!normalise(x, y, length, dir, vertical))
+    {
+        return false;
+    }
+    for (int i = 0; i < length; i++)
+    {
+        if (find(vertical ? x : x + i, vertical ? y + i : y))
+            return false;
+    }
+    return true;
+}
+
+// Places a ship on the board; the caller checks the placement with isValidPlacement first.
+template <int Width, int Height, int MaxShipLength>
+void SparseBoard<Width, Height, MaxShipLength>::placeShip(ShipType &ship, int x, int y, Direction dir)
+{
+    bool vertical;
+    if (!normalise(x, y, ship.getLength(), dir, vertical))
+    {
+        return;
+    }
+
+    std::int32_t index = static_cast<std::int32_t>(ships.size());
+    for (int i = 0; i < ship.getLength(); i++)
+    {
+        Position pos(vertical ? x : x + i, vertical ? y + i : y);
+        ship.addPosition(pos);
+        cells[key(pos.x, pos.y)] = CellState{index, 0};
+    }
+    shipCellCount += ship.getLength();
+    ships.push_back(ship);
+}
+
+// Places the ships of a fleet randomly on the board.
+// Each ship draws placements uniformly from all placements of its length until one is free,
+// which is a uniform choice among the free ones; on a sparse ocean the first draw almost
+// always succeeds, so no placement table is needed.
+template <int Width, int Height, int MaxShipLength>
+void SparseBoard<Width, Height, MaxShipLength>::placeRandomShips(const Fleet &fleet, Rng &rng)
+{
+    for (int i = 0; i < fleet.size; i++)
+    {
+        const ShipDef &def = fleet.ships[i];
+        std::int64_t horizontal = def.length <= Width ? std::int64_t(Height) * (Width - def.length + 1) : 0;
+        std::int64_t vertical = def.length > 1 && def.length <= Height ? std::int64_t(Width) * (Height - def.length + 1) : 0;
+        if (horizontal + vertical == 0)
+        {
+            return; // this board cannot hold a ship of that length
+        }
+
+        bool placed = false;
+        for (int attempt = 0; attempt < MAX_PLACEMENT_ATTEMPTS && !placed; attempt++)
+        {
+            std::int64_t p = rng.below(static_cast<std::uint32_t>(horizontal + vertical));
+            int x, y;
+            Direction dir;
+            if (p < horizontal)
+            {
+                x = static_cast<int>(p % (Width - def.length + 1));
+                y = static_cast<int>(p / (Width - def.length + 1));
+                dir = RIGHT;
+            }
+            else
+            {
+                x = static_cast<int>((p - horizontal) % Width);
+                y = static_cast<int>((p - horizontal) / Width);
+                dir = DOWN;
+            }
+            if (isValidPlacement(x, y, def.length, dir))
+            {
+                ShipType ship(def.type, def.length);
+                placeShip(ship, x, y, dir);
+                placed = true;
+            }
+        }
+        if (!placed)
+        {
+            return; // the board is too full for this fleet
+        }
+    }
+}
+
+// Processes a shot at a given coordinate, with the same outcomes as BasicBoard::processShot.
+template <int Width, int Height, int MaxShipLength>
+ShotResult SparseBoard<Width, Height, MaxShipLength>::processShot(int x, int y)
+{
+    ShotResult result = {SHOT_INVALID, 0, false};
+    if (!contains(x, y))
+    {
+        return result;
+    }
+
+    auto it = cells.find(key(x, y));
+
+    // miss: open water becomes a stored miss
+    if (it == cells.end())
+    {
+        cells.emplace(key(x, y), CellState{-1, MISS_CHAR});
+        stateHash ^= shotKey(x, y, MISS_CHAR);
+        result.outcome = SHOT_MISS;
+        return result;
+    }
+
+    CellState &state = it->second;
+
+    // Already shot here
+    if (state.shot)
+    {
+        result.outcome = SHOT_ALREADY_TAKEN;
+        return result;
+    }
+
+    if (state.ship < 0)
+    {
+        state.shot = MISS_CHAR;
+        stateHash ^= shotKey(x, y, MISS_CHAR);
+        result.outcome = SHOT_MISS;
+        return result;
+    }
+
+    // hit: the cell leads straight to the ship
+    state.shot = HIT_CHAR;
+    stateHash ^= shotKey(x, y, HIT_CHAR);
+    hitShipCount++;
+    ShipType &ship = ships[state.ship];
+    ship.hit();
+
+    result.shipType = ship.getType();
+    result.outcome = ship.isDestroyed() ? SHOT_SUNK : SHOT_HIT;
+    result.gameOver = result.outcome == SHOT_SUNK && hitShipCount == shipCellCount;
+    return result;
+}
+
+// Checks if a specific ship type has been destroyed.
+template <int Width, int Height, int MaxShipLength>
+bool SparseBoard<Width, Height, MaxShipLength>::isShipDestroyed(char shipType) const
+{
+    for (const auto &ship : ships)
+    {
+        if (ship.getType() == shipType)
+        {
+            return ship.isDestroyed();
+        }
+    }
+    return false;
+}
+
+#endif
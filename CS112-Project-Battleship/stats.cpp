@@ -0,0 +1,218 @@
+#include "stats.h"
+
+#include <cmath>
+#include <iomanip>
+
+namespace
+{
+    const int CELLS = BOARD_SIZE * BOARD_SIZE;
+    const double PERCENTS[] = {1, 10, 25, 50, 75, 90, 99};
+
+    // Largest value each metric can take in a classic game
+    int metricRange(int metric)
+    {
+        switch (metric)
+        {
+        case STAT_SHOTS_TO_WIN:
+            return CELLS;
+        case STAT_TURNS_PER_GAME:
+            return 2 * CELLS;
+        default:
+            return CLASSIC_WINNING_SCORE;
+        }
+    }
+}
+
+// Histogram implementation
+Histogram::Histogram(int maxValue) : counts(maxValue + 1, 0), samples(0), sum(0), sumSquares(0) {}
+
+// Adds the samples of other; both histograms must have the same range
+void Histogram::merge(const Histogram &other)
+{
+    for (size_t v = 0; v < counts.size() && v < other.counts.size(); v++)
+        counts[v] += other.counts[v];
+    samples += other.samples;
+    sum += other.sum;
+    sumSquares += other.sumSquares;
+}
+
+double Histogram::mean() const
+{
+    return samples ? static_cast<double>(sum) / samples : 0;
+}
+
+// Sample standard deviation
+double Histogram::standardDeviation() const
+{
+    if (samples < 2)
+        return 0;
+    double m = mean();
+    double variance = (static_cast<double>(sumSquares) - samples * m * m) / (samples - 1);
+    return variance > 0 ? std::sqrt(variance) : 0;
+}
+
+// Normal approximation, which is accurate for the sample counts simulations produce
+double Histogram::confidence95() const
+{
+    return samples ? 1.96 * standardDeviation() / std::sqrt(static_cast<double>(samples)) : 0;
+}
+
+int Histogram::percentile(double percent) const
+{
+    if (samples == 0)
+        return 0;
+    unsigned long long needed = static_cast<unsigned long long>(percent / 100.0 * samples + 0.5);
+    if (needed == 0)
+        needed = 1;
+    unsigned long long seen = 0;
+    for (size_t v = 0; v < counts.size(); v++)
+    {
+        seen += counts[v];
+        if (seen >= needed)
+            return static_cast<int>(v);
+    }
+    return static_cast<int>(counts.size()) - 1;
+}
+
+int Histogram::minimum() const
+{
+    for (size_t v = 0; v < counts.size(); v++)
+    {
+        if (counts[v])
+            return static_cast<int>(v);
+    }
+    return 0;
+}
+
+int Histogram::maximum() const
+{
+    for (size_t v = counts.size(); v-- > 0;)
+    {
+        if (counts[v])
+            return static_cast<int>(v);
+    }
+    return 0;
+}
+
+// SimulationStats implementation
+SimulationStats::SimulationStats() : games(0), wins{0, 0}, shots(0), hits(0)
+{
+    for (int m = 0; m < STAT_METRIC_COUNT; m++)
+        metrics[m] = Histogram(metricRange(m));
+}
+
+void SimulationStats::merge(const SimulationStats &other)
+{
+    games += other.games;
+    wins[0] += other.wins[0];
+    wins[1] += other.wins[1];
+    shots += other.shots;
+    hits += other.hits;
+    for (int m = 0; m < STAT_METRIC_COUNT; m++)
+        metrics[m].merge(other.metrics[m]);
+}
+
+// GameTally implementation
+void GameTally::begin()
+{
+    shots = 0;
+    turns = 0;
+    lastSide = -1;
+    for (int side = 0; side < 2; side++)
+    {
+        hits[side] = 0;
+        firstSinkHits[side] = 0;
+        streak[side] = 0;
+    }
+    for (int &count : streaks)
+        count = 0;
+}
+
+// Closes the open hit streaks and adds the game's per-game metrics
+void GameTally::finish(int winner, int winnerShots, SimulationStats &stats)
+{
+    stats.shots += shots;
+    stats.hits += hits[0] + hits[1];
+    for (int side = 0; side < 2; side++)
+        streaks[streak[side]]++;
+    for (int length = 1; length <= CLASSIC_WINNING_SCORE; length++)
+    {
+        if (streaks[length])
+            stats.metrics[STAT_HIT_STREAK].add(length, streaks[length]);
+    }
+    if (winner < 0)
+    {
+        begin();
+        return;
+    }
+
+    stats.games++;
+    stats.wins[winner]++;
+    stats.metrics[STAT_SHOTS_TO_WIN].add(winnerShots);
+    stats.metrics[STAT_TURNS_PER_GAME].add(turns);
+    for (int side = 0; side < 2; side++)
+    {
+        if (firstSinkHits[side] > 0)
+            stats.metrics[STAT_HITS_BEFORE_FIRST_SINK].add(firstSinkHits[side]);
+    }
+    begin();
+}
+
+const char *statMetricName(StatMetric metric)
+{
+    switch (metric)
+    {
+    case STAT_SHOTS_TO_WIN:
+        return "shots_to_win";
+    case STAT_HITS_BEFORE_FIRST_SINK:
+        return "hits_before_first_sink";
+    case STAT_TURNS_PER_GAME:
+        return "turns_per_game";
+    case STAT_HIT_STREAK:
+        return "hit_streak";
+    default:
+        return "unknown";
+    }
+}
+
+void writeStatsCsv(const SimulationStats &stats, std::ostream &out)
+{
+    out << "metric,count,mean,stddev,ci95_low,ci95_high,min";
+    for (double p : PERCENTS)
+        out << ",p" << static_cast<int>(p);
+    out << ",max\n";
+
+    out << std::fixed << std::setprecision(4);
+    for (int m = 0; m < STAT_METRIC_COUNT; m++)
+    {
+        const Histogram &h = stats.metrics[m];
+        out << statMetricName(static_cast<StatMetric>(m)) << "," << h.getSamples() << "," << h.mean() << ","
+            << h.standardDeviation() << "," << h.mean() - h.confidence95() << "," << h.mean() + h.confidence95() << ","
+            << h.minimum();
+        for (double p : PERCENTS)
+            out << "," << h.percentile(p);
+        out << "," << h.maximum() << "\n";
+    }
+}
+
+void writeStatsJson(const SimulationStats &stats, std::ostream &out)
+{
+    out << std::fixed << std::setprecision(4);
+    out << "{\n  \"games\": " << stats.games << ",\n  \"wins\": [" << stats.wins[0] << ", " << stats.wins[1] << "],\n"
+        << "  \"shots\": " << stats.shots << ",\n  \"hits\": " << stats.hits << ",\n  \"metrics\": {\n";
+    for (int m = 0; m < STAT_METRIC_COUNT; m++)
+    {
+        const Histogram &h = stats.metrics[m];
+        out << "    \"" << statMetricName(static_cast<StatMetric>(m)) << "\": {\"count\": " << h.getSamples()
+            << ", \"mean\": " << h.mean() << ", \"stddev\": " << h.standardDeviation()
+            << ", \"ci95\": [" << h.mean() - h.confidence95() << ", " << h.mean() + h.confidence95() << "]"
+            << ", \"min\": " << h.minimum() << ", \"max\": " << h.maximum() << ", \"percentiles\": {";
+        for (size_t i = 0; i < sizeof(PERCENTS) / sizeof(PERCENTS[0]); i++)
+            out << (i ? ", " : "") << "\"p" << static_cast<int>(PERCENTS[i]) << "\": " << h.percentile(PERCENTS[i]);
+        out << "}, \"histogram\": [";
+        for (size_t v = 0; v < h.getCounts().size(); v++)
+            out << (v ? ", " : "") << h.getCounts()[v];
+        out << "]}" << (m + 1 < STAT_METRIC_COUNT ? "," : "") << "\n";
+    }
+    out << "  }\n}\n";
+}
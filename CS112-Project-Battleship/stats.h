@@ -0,0 +1,118 @@
+#ifndef STATS_H
+#define STATS_H
+#include "board.h"
+#include <ostream>
+#include <vector>
+
+// Game statistics for large simulation runs.
+// Every worker thread fills its own SimulationStats with plain (non-atomic) counters, and the
+// owner merges them once the workers are done, so no lock or shared cache line is touched per
+// shot. All counters are integers, so merged results do not depend on the number of threads.
+
+// Distribution of a small non-negative integer quantity: one counter per value, plus the exact
+// sum and sum of squares for the mean and its confidence interval
+class Histogram
+{
+private:
+    std::vector<unsigned long long> counts; // counts[v] = samples equal to v; the last bucket also takes larger values
+    unsigned long long samples;
+    unsigned long long sum;
+    unsigned long long sumSquares;
+
+public:
+    explicit Histogram(int maxValue = 0);
+
+    void add(int value, unsigned long long times = 1)
+    {
+        unsigned long long v = value < 0 ? 0 : static_cast<unsigned long long>(value);
+        counts[v < counts.size() ? v : counts.size() - 1] += times;
+        samples += times;
+        sum += v * times;
+        sumSquares += v * v * times;
+    }
+    void merge(const Histogram &other);
+
+    unsigned long long getSamples() const { return samples; }
+    const std::vector<unsigned long long> &getCounts() const { return counts; }
+    double mean() const;
+    double standardDeviation() const;
+    double confidence95() const; // half-width of the 95% confidence interval of the mean
+    int percentile(double percent) const; // smallest value at or above percent% of the samples
+    int minimum() const;
+    int maximum() const;
+};
+
+// quantities measured per game
+enum StatMetric
+{
+    STAT_SHOTS_TO_WIN,           // shots the winner fired
+    STAT_HITS_BEFORE_FIRST_SINK, // hits a side scored up to and including its first sink
+    STAT_TURNS_PER_GAME,         // turns of both sides; a turn lasts until a miss
+    STAT_HIT_STREAK,             // length of each run of consecutive hits by one side
+    STAT_METRIC_COUNT
+};
+
+// Statistics of a set of games. Aligned to a cache line so per-thread copies do not share one.
+struct alignas(64) SimulationStats
+{
+    unsigned long long games;
+    unsigned long long wins[2];
+    unsigned long long shots; // shots that changed the game, both sides
+    unsigned long long hits;
+    Histogram metrics[STAT_METRIC_COUNT];
+
+    SimulationStats();
+    void merge(const SimulationStats &other);
+};
+
+// Follows one game shot by shot and adds it to a SimulationStats when it ends.
+// Everything per shot stays in the tally, so the shared histograms are only touched once per game.
+class GameTally
+{
+private:
+    int shots;
+    int hits[2];
+    int firstSinkHits[2]; // 0 until the side sinks a ship
+    int streak[2];        // current run of hits
+    int turns;
+    int lastSide;
+    int streaks[CLASSIC_WINNING_SCORE + 1]; // finished hit streaks of this game by length
+
+public:
+    GameTally() { begin(); }
+
+    void begin();
+
+    // Counts a shot that changed the game (a miss, hit or sink) fired by side
+    void shot(int side, const ShotResult &result)
+    {
+        if (side != lastSide)
+        {
+            turns++;
+            lastSide = side;
+        }
+        shots++;
+        if (result.outcome == SHOT_MISS)
+        {
+            streaks[streak[side]]++; // streaks[0] counts misses after a miss and is ignored
+            streak[side] = 0;
+            return;
+        }
+        hits[side]++;
+        streak[side]++;
+        if (result.outcome == SHOT_SUNK && firstSinkHits[side] == 0)
+            firstSinkHits[side] = hits[side];
+    }
+
+    // Ends the game; winner is -1 for an unfinished game, which only adds its shot counts
+    void finish(int winner, int winnerShots, SimulationStats &stats);
+};
+
+const char *statMetricName(StatMetric metric);
+
+// Summary of every metric, one row each: count, mean, standard deviation, 95% interval and percentiles
+void writeStatsCsv(const SimulationStats &stats, std::ostream &out);
+// The same summary plus the game counts and each metric's full histogram
+void writeStatsJson(const SimulationStats &stats, std::ostream &out);
+
+#endif
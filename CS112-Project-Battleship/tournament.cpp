@@ -0,0 +1,289 @@
+#include "tournament.h"
+#include "engine.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <thread>
+
+namespace
+{
+    const std::uint32_t CHUNK_SIZE = 16; // games a worker claims from its own range at a time
+
+    // A range of game indices owned by one worker, packed as (begin << 32 | end).
+    // The owner takes chunks from the front and thieves split off the back half;
+    // both sides update the range with a single compare-and-swap, so no locks are needed.
+    struct alignas(64) WorkRange
+    {
+        std::atomic<std::uint64_t> packed;
+
+        static std::uint64_t pack(std::uint32_t begin, std::uint32_t end)
+        {
+            return (static_cast<std::uint64_t>(begin) << 32) | end;
+        }
+
+        void assign(std::uint32_t begin, std::uint32_t end)
+        {
+            packed.store(pack(begin, end));
+        }
+
+        // Owner: claim up to CHUNK_SIZE games from the front
+        bool take(std::uint32_t &begin, std::uint32_t &end)
+        {
+            std::uint64_t current = packed.load();
+            while (true)
+            {
+                std::uint32_t b = static_cast<std::uint32_t>(current >> 32);
+                std::uint32_t e = static_cast<std::uint32_t>(current);
+                if (b >= e)
+                    return false;
+                std::uint32_t split = (e - b > CHUNK_SIZE) ? b + CHUNK_SIZE : e;
+                if (packed.compare_exchange_weak(current, pack(split, e)))
+                {
+                    begin = b;
+                    end = split;
+                    return true;
+                }
+            }
+        }
+
+        // Thief: take the back half of whatever is left
+        bool steal(std::uint32_t &begin, std::uint32_t &end)
+        {
+            std::uint64_t current = packed.load();
+            while (true)
+            {
+                std::uint32_t b = static_cast<std::uint32_t>(current >> 32);
+                std::uint32_t e = static_cast<std::uint32_t>(current);
+                if (b >= e)
+                    return false;
+                std::uint32_t mid = b + (e - b) / 2;
+                if (packed.compare_exchange_weak(current, pack(b, mid)))
+                {
+                    begin = mid;
+                    end = e;
+                    return true;
+                }
+            }
+        }
+    };
+
+    // Per-worker results; each worker writes only its own entry
+    struct alignas(64) WorkerStats
+    {
+        SimulationStats stats;
+        int longestWin = 0;
+        std::uint64_t longestWinSeed = 0;
+    };
+
+    // Keeps the longest win, preferring the lower seed on ties so the result does not depend on scheduling
+    void noteLongestWin(int &longestWin, std::uint64_t &longestWinSeed, int shots, std::uint64_t seed)
+    {
+        if (shots > longestWin || (shots == longestWin && seed < longestWinSeed))
+        {
+            longestWin = shots;
+            longestWinSeed = seed;
+        }
+    }
+
+    // Plays one CPU-vs-CPU game to completion on engine and returns the winning side.
+    // Each side makes all of its random decisions with its own generator from rngs; every shot
+    // goes to tally, which adds the game to stats at the end.
+    template <class FirstAi, class SecondAi>
+    int playSelfPlayGame(GameEngine &engine, FirstAi &first, SecondAi &second, Rng (&rngs)[2], GameTally &tally, SimulationStats &stats)
+    {
+        engine.reset();
+        first.reset();
+        second.reset();
+        engine.getPlayer(FIRST_SIDE).getOwnBoard().placeRandomShips(false, rngs[FIRST_SIDE]);
+        engine.getPlayer(SECOND_SIDE).getOwnBoard().placeRandomShips(true, rngs[SECOND_SIDE]);
+
+        int forfeitsInARow = 0;
+        while (!engine.isGameOver())
+        {
+            int side = engine.getCurrentSide();
+            ShotResult result = side == FIRST_SIDE ? first.takeShot(engine, rngs[FIRST_SIDE])
+                                                   : second.takeShot(engine, rngs[SECOND_SIDE]);
+            if (result.outcome == SHOT_MISS || result.outcome == SHOT_HIT || result.outcome == SHOT_SUNK)
+            {
+                tally.shot(side, result);
+                forfeitsInARow = 0;
+                continue;
+            }
+            // The strategy picked a cell it cannot fire at: it forfeits the shot. Once both sides
+            // have done that in a row the game cannot progress and is abandoned.
+            engine.forfeit();
+            if (++forfeitsInARow == 2)
+                break;
+        }
+        int winner = engine.getWinner();
+        tally.finish(winner, winner < 0 ? 0 : engine.getShotsFired(winner), stats);
+        return winner;
+    }
+
+    // Worker loop: drain the own range, then steal from the others until everything is empty
+    template <class FirstAi, class SecondAi>
+    void runWorker(unsigned int id, std::vector<WorkRange> &ranges, WorkerStats &stats, const TournamentConfig &config)
+    {
+        Rng rngs[2];
+        GameEngine engine("First", "Second");
+        FirstAi first;
+        SecondAi second;
+        GameRecord record;
+        GameTally tally;
+        if (config.recorder)
+            engine.setRecord(&record);
+
+        unsigned int count = static_cast<unsigned int>(ranges.size());
+        std::uint32_t begin, end;
+        while (true)
+        {
+            while (ranges[id].take(begin, end))
+            {
+                for (std::uint32_t game = begin; game < end; game++)
+                {
+                    // Each game has its own seed, so the result does not depend on which worker ran it
+                    std::uint64_t seed = deriveSeed(config.seed, game);
+                    rngs[FIRST_SIDE].reseed(deriveSeed(seed, FIRST_SIDE));
+                    rngs[SECOND_SIDE].reseed(deriveSeed(seed, SECOND_SIDE));
+                    record.begin(seed, config.firstStrategy, config.secondStrategy);
+                    int winner = playSelfPlayGame(engine, first, second, rngs, tally, stats.stats);
+                    if (config.recorder)
+                    {
+                        record.setFleet(FIRST_SIDE, engine.getPlayer(FIRST_SIDE).getOwnBoard());
+                        record.setFleet(SECOND_SIDE, engine.getPlayer(SECOND_SIDE).getOwnBoard());
+                        record.finish(winner);
+                        config.recorder->write(record);
+                    }
+                    if (winner >= 0)
+                        noteLongestWin(stats.longestWin, stats.longestWinSeed, engine.getShotsFired(winner), seed);
+                }
+            }
+
+            bool stolen = false;
+            for (unsigned int i = 1; i < count && !stolen; i++)
+            {
+                if (ranges[(id + i) % count].steal(begin, end))
+                {
+                    ranges[id].assign(begin, end);
+                    stolen = true;
+                }
+            }
+            if (!stolen)
+                return;
+        }
+    }
+}
+
+double TournamentReport::gamesPerSecond() const
+{
+    return seconds > 0 ? games / seconds : 0;
+}
+
+// Plays config.games self-play games across the worker threads and merges their results
+TournamentReport runTournament(const TournamentConfig &config)
+{
+    unsigned int threads = config.threads;
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+
+    // Give every worker an equal slice up front; stealing evens out the differences in game length
+    std::vector<WorkRange> ranges(threads);
+    for (unsigned int i = 0; i < threads; i++)
+    {
+        std::uint64_t begin = static_cast<std::uint64_t>(config.games) * i / threads;
+        std::uint64_t end = static_cast<std::uint64_t>(config.games) * (i + 1) / threads;
+        ranges[i].assign(static_cast<std::uint32_t>(begin), static_cast<std::uint32_t>(end));
+    }
+    std::vector<WorkerStats> stats(threads);
+
+    // The workers already keep every core busy, so each decision, sampled or counted, stays on
+    // the thread of the worker making it
+    SamplingLimits limits = samplingLimits();
+    SamplingLimits perWorker = limits;
+    perWorker.threads = 1;
+    setSamplingLimits(perWorker);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < threads; i++)
+    {
+        workers.emplace_back([&, i]()
+                             {
+            // Instantiate the worker for the chosen pair so strategy calls inline
+            visitStrategyType(config.firstStrategy, [&](auto first)
+                              { visitStrategyType(config.secondStrategy, [&](auto second)
+                                                  { runWorker<decltype(first), decltype(second)>(i, ranges, stats[i], config); }); }); });
+    }
+    for (auto &worker : workers)
+        worker.join();
+    auto finish = std::chrono::steady_clock::now();
+    setSamplingLimits(limits);
+
+    TournamentReport report;
+    report.games = config.games;
+    report.threads = threads;
+    report.seconds = std::chrono::duration<double>(finish - start).count();
+    int longestWin = 0;
+    std::uint64_t longestWinSeed = 0;
+    for (const auto &s : stats)
+    {
+        if (s.longestWin > 0)
+            noteLongestWin(longestWin, longestWinSeed, s.longestWin, s.longestWinSeed);
+        report.stats.merge(s.stats);
+    }
+    report.longestWin = longestWin;
+    report.longestWinSeed = longestWinSeed;
+    return report;
+}
+
+// Plays one game from its seed with the tournament's per-side generators and records it
+int playSeededGame(CpuStrategy firstStrategy, CpuStrategy secondStrategy, std::uint64_t seed, GameRecord &record)
+{
+    GameEngine engine("First", "Second");
+    engine.setRecord(&record);
+    Rng rngs[2] = {Rng(deriveSeed(seed, FIRST_SIDE)), Rng(deriveSeed(seed, SECOND_SIDE))};
+    record.begin(seed, firstStrategy, secondStrategy);
+
+    GameTally tally;
+    SimulationStats stats;
+    int winner = -1;
+    visitStrategyType(firstStrategy, [&](auto first)
+                      { visitStrategyType(secondStrategy, [&](auto second)
+                                          { winner = playSelfPlayGame(engine, first, second, rngs, tally, stats); }); });
+    record.setFleet(FIRST_SIDE, engine.getPlayer(FIRST_SIDE).getOwnBoard());
+    record.setFleet(SECOND_SIDE, engine.getPlayer(SECOND_SIDE).getOwnBoard());
+    record.finish(winner);
+    return winner;
+}
+
+// Prints throughput, win counts and the shots-to-win distribution
+void printTournamentReport(const TournamentConfig &config, const TournamentReport &report, std::ostream &out)
+{
+    out << "Self-play: " << cpuStrategyName(config.firstStrategy) << " vs " << cpuStrategyName(config.secondStrategy)
+        << ", " << report.games << " games on " << report.threads << " threads\n";
+    out << std::fixed << std::setprecision(3);
+    out << "  time:           " << report.seconds << " s\n";
+    out << "  games/sec:      " << std::setprecision(1) << report.gamesPerSecond() << "\n";
+    out << "  wins:           first " << report.stats.wins[0] << ", second " << report.stats.wins[1] << "\n";
+    out << "  hit rate:       " << std::setprecision(3)
+        << (report.stats.shots ? static_cast<double>(report.stats.hits) / report.stats.shots : 0) << "\n";
+
+    // One line per metric: mean with its 95% interval, then the percentiles
+    const char *labels[STAT_METRIC_COUNT] = {"shots/win:       ", "hits to 1st sink:", "turns/game:      ", "hit streak:      "};
+    const double percents[] = {1, 10, 25, 50, 75, 90, 99};
+    for (int m = 0; m < STAT_METRIC_COUNT; m++)
+    {
+        const Histogram &h = report.stats.metrics[m];
+        out << "  " << labels[m] << " mean " << std::setprecision(2) << h.mean() << " +/- " << h.confidence95() << "  ";
+        for (double p : percents)
+        {
+            out << " p" << static_cast<int>(p) << "=" << h.percentile(p);
+        }
+        out << "\n";
+    }
+    out << "  longest win:    " << report.longestWin << " shots (game seed " << report.longestWinSeed << ")\n";
+}
\ No newline at end of file
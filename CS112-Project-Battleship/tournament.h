@@ -0,0 +1,41 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+#include "ai.h"
+#include "record.h"
+#include "stats.h"
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Batch self-play: CPU-vs-CPU games spread over worker threads with work stealing.
+
+struct TournamentConfig
+{
+    unsigned int games;
+    unsigned int threads; // 0 = one per hardware thread
+    CpuStrategy firstStrategy;
+    CpuStrategy secondStrategy;
+    unsigned long long seed; // base seed; game i is played from deriveSeed(seed, i)
+    RecordWriter *recorder;  // receives a record of every game, if set
+};
+
+struct TournamentReport
+{
+    unsigned int games;
+    unsigned int threads;
+    double seconds;
+    SimulationStats stats;              // per-worker statistics, merged after the run
+    int longestWin;                     // most shots any winner needed
+    unsigned long long longestWinSeed;  // seed of that game, to replay it
+
+    double gamesPerSecond() const;
+};
+
+TournamentReport runTournament(const TournamentConfig &config);
+void printTournamentReport(const TournamentConfig &config, const TournamentReport &report, std::ostream &out);
+
+// Plays the self-play game with the given game seed exactly as a tournament does, into record;
+// returns the winning side. A seed from the report (e.g. the longest win) regenerates that game.
+int playSeededGame(CpuStrategy firstStrategy, CpuStrategy secondStrategy, std::uint64_t seed, GameRecord &record);
+
+#endif
\ No newline at end of file
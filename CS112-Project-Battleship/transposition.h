@@ -0,0 +1,99 @@
+#ifndef TRANSPOSITION_H
+#define TRANSPOSITION_H
+
+#include "bitboard.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// A bounded cache from a position's 64-bit hash to the decision a strategy made there, shared by
+// every game and worker thread. Self-play games keep reaching the same early positions, so a
+// strategy that looks its position up first can skip recounting it.
+//
+// The table has a fixed number of slots and a new entry simply overwrites whatever was in its slot.
+// Slots are guarded by a sequence number instead of a lock: a writer makes it odd while it
+// fills the slot, and a reader that sees it odd or changed treats the lookup as a miss. Lookups
+// therefore never block, and a torn or lost entry only costs a recount.
+
+// Cells that decide a target picked by weight: scanning the open cells in index order, raises are
+// the cells that set a new highest weight and draws the cells that tied it, each tie costing one
+// draw from the strategy's generator. Replaying the two sets gives the same target and the same
+// generator state as the scan itself.
+struct CachedDecision
+{
+    Bitboard raises;
+    Bitboard draws;
+};
+
+class TranspositionCache
+{
+private:
+    struct alignas(32) Slot
+    {
+        std::atomic<std::uint64_t> sequence; // 0 for a slot never written, odd while being written
+        std::atomic<std::uint64_t> key;
+        std::atomic<std::uint64_t> raises;
+        std::atomic<std::uint64_t> draws;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t mask;
+
+public:
+    // A cache of 2^bits slots of 32 bytes each
+    explicit TranspositionCache(int bits) : slots(new Slot[std::size_t(1) << bits]), mask((std::size_t(1) << bits) - 1)
+    {
+        for (std::size_t i = 0; i <= mask; i++)
+        {
+            slots[i].sequence.store(0, std::memory_order_relaxed);
+            slots[i].key.store(0, std::memory_order_relaxed);
+            slots[i].raises.store(0, std::memory_order_relaxed);
+            slots[i].draws.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Copies the decision stored for key into decision; returns false if there is none
+    bool find(std::uint64_t key, CachedDecision &decision) const
+    {
+        const Slot &slot = slots[key & mask];
+        std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before == 0 || (before & 1) || slot.key.load(std::memory_order_relaxed) != key)
+            return false;
+        decision.raises = slot.raises.load(std::memory_order_relaxed);
+        decision.draws = slot.draws.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == before;
+    }
+
+    // Stores the decision for key, replacing the slot's entry; skipped if another thread is writing it
+    void store(std::uint64_t key, const CachedDecision &decision)
+    {
+        Slot &slot = slots[key & mask];
+        std::uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+        if ((sequence & 1) || !slot.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire))
+            return;
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.key.store(key, std::memory_order_relaxed);
+        slot.raises.store(decision.raises, std::memory_order_relaxed);
+        slot.draws.store(decision.draws, std::memory_order_relaxed);
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // The process-wide cache of density decisions (2^16 slots, 2 MiB)
+    static TranspositionCache &densityDecisions()
+    {
+        static TranspositionCache cache(16);
+        return cache;
+    }
+
+    // The process-wide cache of exact-count decisions (2^12 slots; each miss costs a full count,
+    // so the opening positions that recur from game to game are what it is for)
+    static TranspositionCache &exactDecisions()
+    {
+        static TranspositionCache cache(12);
+        return cache;
+    }
+};
+
+#endif